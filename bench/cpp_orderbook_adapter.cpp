@@ -2,31 +2,39 @@
 // matching_engine_api.h ABI.
 //
 // cpp-orderbook is a header-template C++ limit-order book whose
-// OrderBook<Notification> fires a single onExecutionReport(ExecutionReport)
-// callback per event (New/Rejected/Canceled/Trade). This adapter:
-//   - implements a NotificationInterface whose onExecutionReport converts
-//     each Trade into a harness ME_TRADE report and records the engine's
-//     cancel verdict (Canceled vs Rejected(OrderNotExists))
+// OrderBook<Notification> fires one compact per-event hook (onNew / onCancel /
+// onReplace / onReject / onTrade) per event. This adapter:
+//   - implements a NotificationInterface whose onTrade converts each Trade
+//     into a harness ME_TRADE report and whose onCancel / onReplace record the
+//     engine's cancel / modify verdict
 //   - synthesises ME_ORDER_ACK / ME_CANCEL_ACK / ME_MODIFY_ACK /
 //     ME_CANCEL_REJECT / ME_MODIFY_REJECT above the engine — the Trade/cancel
 //     callbacks lack the side/price the harness wire format requires
 //   - shadow-tracks {oid -> price,side,remaining,alive} for the side/price
-//     echo and as the source of truth for the audit queries
+//     echo; the audit queries (best bid / ask, depth at a price) come straight
+//     from the engine's level store
 //
-// Modify is cancel + reinsert (the engine has no native modify; this matches
-// the harness contract: fills cross with the modify's seq). This mirrors the
-// geseq Go adapter (additional_references/geseq_adapter) one-for-one, except
-// cpp-orderbook's addOrder/cancelOrder take no monotonic token (the Go engine
-// does), so there is no token counter here.
+// Setting ME_RECORD_PATH records every message the adapter receives, as the
+// engine Command it maps to, into a replay file (replay_file.hpp) that the
+// replay tool can drive a book from without the harness.
+//
+// Modify goes through the engine's native modifyOrder, which keeps the Order
+// object and index entry (no erase + insert, no pool release + acquire). A
+// quantity-down amend at the same price keeps queue priority; a price change
+// re-enters the order and any crossing fills carry the modify's seq. Otherwise
+// this mirrors the geseq Go adapter (additional_references/geseq_adapter),
+// except cpp-orderbook's addOrder/cancelOrder take no monotonic token (the Go
+// engine does), so there is no token counter here.
 //
 // PERFORMANCE NOTES
 // -----------------
-// The engine's per-event report callback (onExecutionReport) is reached through
-// the CRTP NotificationInterface<Implementation>, i.e. a non-virtual, non-
-// std::function static dispatch the compiler can inline. This adapter's
-// HarnessNotification is a concrete struct with a single non-virtual handler,
-// so the engine inlines straight into it and the adapter adds NO indirection of
-// its own (no virtual, no std::function, no type erasure).
+// The engine's per-event hooks are reached through the CRTP
+// NotificationInterface<Implementation>, i.e. a non-virtual, non-std::function
+// static dispatch the compiler can inline. This adapter's HarnessNotification
+// overrides every hook with a concrete non-virtual handler taking the compact
+// report (TradeReport is 40 bytes vs the ~100-byte ExecutionReport), so the
+// engine inlines straight into it and the adapter adds NO indirection of its
+// own (no virtual, no std::function, no type erasure).
 //
 // The engine DOES route per-fill trade/fill notifications through std::function
 // internally: OrderQueue::process / PriceLevel::process{Market,Limit}Order take
@@ -34,7 +42,7 @@
 // orderqueue.hpp), and src/pricelevel.cpp is *explicitly instantiated* against
 // those std::function types. That indirection is therefore ENGINE-level and
 // cannot be removed from the adapter without re-templating the engine; the
-// adapter just hands the engine the same onExecutionReport sink it always uses.
+// adapter just hands the engine the same hook set it always uses.
 //
 // Everything the adapter controls is on the stack and branch-lean: the report
 // struct is a stack local, the shadow store is a flat array indexed by order id
@@ -44,19 +52,22 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <optional>
 #include <vector>
 
 #include "matching_engine_api.h"
 #include "orderbook.hpp"
+#include "replay_file.hpp"
 #include "types.hpp"
 
 // Report transport backend: geseq/cpp-fastchan.
 #include "spsc.hpp"
 
 using orderbook::Decimal;
-using orderbook::ExecType;
-using orderbook::ExecutionReport;
+using orderbook::OrderReport;
+using orderbook::RejectReport;
+using orderbook::TradeReport;
 using orderbook::Flag;
 using orderbook::OrderBook;
 using orderbook::OrderID;
@@ -68,31 +79,27 @@ using orderbook::Type;
 // ---------------------------------------------------------------------------
 // Decimal conversions.
 //
-// Workload ticks are positive signed integers. Decimal = decimal::U8 carries
-// each tick as Decimal(tick, 0) which produces internal fp = tick * 10^8. The
-// engine compares fp directly, so a strictly increasing tick mapping is
-// preserved bit-for-bit, and d.to_int() recovers fp / 10^8 = tick exactly
-// (round-trips). This mirrors the geseq Go adapter's udecimal.New(tick,0) /
-// d.Int().
-//
-// Decimal(i, 0) is a single constant multiply (i * 10^8 via precomputed_pow_10)
-// and to_int() is a single constant divide (fp / 10^8) — no string work, no
-// allocation, fully inlined.
+// Workload prices are positive integer ticks and quantities integer lots. The
+// book is built on a tick-unit grid (tick_fp = 1, see README "Integer ticks"),
+// so a tick count is carried as the Decimal's raw fixed-point value: fp = tick,
+// fp = lots. The engine only ever compares, adds and subtracts Decimals, so
+// matching is exact and the conversions below are plain copies — no multiply
+// by 10^8 on the way in and no divide on the way out.
 // ---------------------------------------------------------------------------
 
 HOT_INLINE Decimal toDecPrice(int64_t ticks) {
     if (ticks <= 0) [[unlikely]] {
         return Decimal(uint64_t(0));
     }
-    return Decimal(uint64_t(ticks), 0);
+    return orderbook::decimalFromFp(uint64_t(ticks));
 }
 
-HOT_INLINE Decimal toDecQty(uint32_t q) { return Decimal(uint64_t(q), 0); }
+HOT_INLINE Decimal toDecQty(uint32_t q) { return orderbook::decimalFromFp(q); }
 
-HOT_INLINE int64_t fromDecPrice(const Decimal& d) { return int64_t(d.to_int()); }
+HOT_INLINE int64_t fromDecPrice(const Decimal& d) { return int64_t(d.fp); }
 
 HOT_INLINE uint32_t fromDecQty(const Decimal& d) {
-    uint64_t v = d.to_int();
+    uint64_t v = d.fp;
     if (v > UINT32_MAX) [[unlikely]] {
         return UINT32_MAX;
     }
@@ -104,8 +111,8 @@ HOT_INLINE uint32_t fromDecQty(const Decimal& d) {
 //
 // 16 bytes, packed: int64 price + uint32 remaining + uint8 side + bool alive
 // (+2 pad). Order quantities are uint32_t at the ABI boundary, so remaining
-// never exceeds uint32_t. Keeping the slot to 16 bytes (vs 24) halves the
-// cache footprint of the linear audit-query scans.
+// never exceeds uint32_t. Keeping the slot to 16 bytes (vs 24) keeps the
+// per-message shadow touch to a quarter of a cache line.
 // ---------------------------------------------------------------------------
 
 struct Shadow {
@@ -130,13 +137,17 @@ size_t gShadowCap = 0;
 const me_transport_t* gTransport = nullptr;
 void* gSink = nullptr;
 
-// Per-call context: onExecutionReport(Trade) reads gCurSeq, accumulates into
-// gTakerFill, and decrements the maker's shadow. onExecutionReport(Canceled /
-// Rejected) records the engine's cancel verdict in gCancelOK/gCancelQty.
+// Non-null while recording (ME_RECORD_PATH set at engine_init).
+orderbook::bench::ReplayWriter* gRecorder = nullptr;
+
+// Per-call context: onTrade reads gCurSeq, accumulates into gTakerFill, and
+// decrements the maker's shadow. onCancel / onReplace record the engine's
+// cancel / modify verdict in gCancelOK/gCancelQty and gModifyOK.
 uint64_t gCurSeq = 0;
 uint64_t gTakerFill = 0;
 bool gCancelOK = false;
 uint64_t gCancelQty = 0;
+bool gModifyOK = false;
 
 // Forward decls used by the notification handler.
 HOT_INLINE void emitTrade(uint64_t seq, uint64_t makerID, uint64_t takerID, int64_t price, uint32_t qty);
@@ -155,58 +166,55 @@ HOT_INLINE Shadow* shadowSlot(uint64_t oid) {
 // ---------------------------------------------------------------------------
 // Notification handler (cpp-orderbook CRTP NotificationInterface).
 //
-// The engine fires onExecutionReport:
-//  - ExecType::New (CreateOrder, Accepted) once per addOrder, before matching.
-//    Ignored — engine_on_new_order eagerly emits ME_ORDER_ACK with the
-//    side+price the report doesn't carry.
-//  - ExecType::Trade per fill: maker/taker ids + last_qty + last_price.
-//  - ExecType::Canceled (CancelOrder) on a successful cancelOrder: the engine's
-//    cancel verdict. Recorded into gCancelOK/gCancelQty; engine_on_cancel
-//    emits the ME_CANCEL_ACK itself with the side/price the report lacks.
-//  - ExecType::Rejected on a cancel of a not-resting order (CancelOrder +
-//    Error::OrderNotExists) or on duplicate-ID / zero-qty / zero-price create
-//    errors. The cancel reject is the source of the gCancelOK = false verdict;
-//    create rejects don't occur in the canonical workload and are ignored.
+// The engine fires one hook per event:
+//  - onNew (CreateOrder) once per addOrder, before matching. Ignored —
+//    engine_on_new_order eagerly emits ME_ORDER_ACK with the side+price the
+//    report doesn't carry.
+//  - onTrade per fill: maker/taker ids + qty + price.
+//  - onCancel (CancelOrder) on a successful cancelOrder: the engine's cancel
+//    verdict. Recorded into gCancelOK/gCancelQty; engine_on_cancel emits the
+//    ME_CANCEL_ACK itself with the side/price the report lacks.
+//  - onReplace (ModifyOrder) on a successful modifyOrder, before any crossing
+//    fills. Recorded into gModifyOK.
+//  - onReject on a cancel/modify of a not-resting order
+//    (Error::OrderNotExists) or on duplicate-ID / zero-qty / zero-price
+//    errors. The cancel/modify reject is the source of the gCancelOK /
+//    gModifyOK = false verdict; create rejects don't occur in the canonical
+//    workload and are ignored.
 // ---------------------------------------------------------------------------
 
 class HarnessNotification : public orderbook::NotificationInterface<HarnessNotification> {
    public:
-    HOT_INLINE void onExecutionReport(const ExecutionReport& r) {
-        switch (r.exec_type) {
-            case ExecType::Trade: {
-                uint32_t q = fromDecQty(r.last_qty);
-                int64_t p = fromDecPrice(r.last_price);
-                emitTrade(gCurSeq, r.maker_order_id, r.taker_order_id, p, q);
-                gTakerFill += q;
-
-                Shadow* e = shadowSlot(r.maker_order_id);
-                uint32_t rem = e->remaining;
-                rem = (rem >= q) ? uint32_t(rem - q) : 0u;
-                e->remaining = rem;
-                if (rem == 0) {
-                    e->alive = false;
-                }
-                break;
-            }
-            case ExecType::Canceled: {
-                // Public cancelOrder verdict: removed.
-                gCancelOK = true;
-                gCancelQty = fromDecQty(r.qty);
-                break;
-            }
-            case ExecType::Rejected: {
-                // cancelOrder of a not-resting order reports
-                // CancelOrder + OrderNotExists. gCancelOK stays false (set by
-                // the caller before cancelOrder); nothing to record.
-                break;
-            }
-            case ExecType::New:
-            default:
-                // Accept notification carries no payload the adapter needs;
-                // the OrderAck is synthesised above the engine.
-                break;
+    HOT_INLINE void onTrade(const TradeReport& r) {
+        uint32_t q = fromDecQty(r.qty);
+        int64_t p = fromDecPrice(r.price);
+        emitTrade(gCurSeq, r.maker_order_id, r.taker_order_id, p, q);
+        gTakerFill += q;
+
+        Shadow* e = shadowSlot(r.maker_order_id);
+        uint32_t rem = e->remaining;
+        rem = (rem >= q) ? uint32_t(rem - q) : 0u;
+        e->remaining = rem;
+        if (rem == 0) {
+            e->alive = false;
         }
     }
+
+    HOT_INLINE void onCancel(const OrderReport& r) {
+        // Public cancelOrder verdict: removed.
+        gCancelOK = true;
+        gCancelQty = fromDecQty(r.qty);
+    }
+
+    HOT_INLINE void onReplace(const OrderReport&) { gModifyOK = true; }
+
+    // cancelOrder / modifyOrder of a not-resting order reports OrderNotExists.
+    // gCancelOK / gModifyOK stay false (set by the caller); nothing to record.
+    HOT_INLINE void onReject(const RejectReport&) {}
+
+    // Accept notification carries no payload the adapter needs; the OrderAck
+    // is synthesised above the engine.
+    HOT_INLINE void onNew(const OrderReport&) {}
 };
 
 HarnessNotification gNotification;
@@ -254,11 +262,43 @@ HOT_INLINE void emitTrade(uint64_t seq, uint64_t makerID, uint64_t takerID, int6
     emit(&r);
 }
 
+// ---------------------------------------------------------------------------
+// Recording. Each message is written as the engine Command it stands for. A
+// modify to a zero quantity or price is recorded as the cancel the adapter
+// turns it into, so a replay through OrderBook::apply leaves the same book.
+// ---------------------------------------------------------------------------
+
+void recordNewOrder(const new_order_t* o) {
+    gRecorder->append(o->sequence_number, {.kind = orderbook::CommandType::Add,
+                                           .type = Type::Limit,
+                                           .side = (o->side == 0) ? Side::Buy : Side::Sell,
+                                           .flag = (o->ioc != 0) ? Flag::IoC : Flag::None,
+                                           .id = o->order_id,
+                                           .qty = toDecQty(o->quantity),
+                                           .price = toDecPrice(o->price_ticks)});
+}
+
+void recordCancel(const cancel_t* c) { gRecorder->append(c->sequence_number, {.kind = orderbook::CommandType::Cancel, .id = c->order_id}); }
+
+void recordModify(const modify_t* m) {
+    if (m->new_quantity == 0 || m->new_price_ticks <= 0) {
+        gRecorder->append(m->sequence_number, {.kind = orderbook::CommandType::Cancel, .id = m->order_id});
+        return;
+    }
+    gRecorder->append(m->sequence_number, {.kind = orderbook::CommandType::Modify,
+                                           .id = m->order_id,
+                                           .qty = toDecQty(m->new_quantity),
+                                           .price = toDecPrice(m->new_price_ticks)});
+}
+
 // ---------------------------------------------------------------------------
 // Per-message handlers (shared by the per-message ABI and engine_on_batch).
 // ---------------------------------------------------------------------------
 
 HOT_INLINE void onNewOrder(const new_order_t* o) {
+    if (gRecorder != nullptr) [[unlikely]] {
+        recordNewOrder(o);
+    }
     const uint64_t seq = o->sequence_number;
     const uint64_t oid = o->order_id;
     const uint8_t side = o->side;
@@ -269,7 +309,7 @@ HOT_INLINE void onNewOrder(const new_order_t* o) {
     // 1. OrderAck. (Engine fires Accepted too; we ignore that.)
     emitAck(ME_ORDER_ACK, seq, oid, side, price, qty);
 
-    // 2. Drive the engine. onExecutionReport(Trade) reads gCurSeq and writes
+    // 2. Drive the engine. onTrade reads gCurSeq and writes
     //    gTakerFill / decrements the maker shadow.
     gCurSeq = seq;
     gTakerFill = 0;
@@ -300,6 +340,9 @@ HOT_INLINE void onNewOrder(const new_order_t* o) {
 }
 
 HOT_INLINE void onCancel(const cancel_t* c) {
+    if (gRecorder != nullptr) [[unlikely]] {
+        recordCancel(c);
+    }
     const uint64_t seq = c->sequence_number;
     const uint64_t oid = c->order_id;
 
@@ -317,46 +360,78 @@ HOT_INLINE void onCancel(const cancel_t* c) {
     // neither); the quantity is the engine's own reported remainder.
     Shadow* e = shadowSlot(oid);
     emitAck(ME_CANCEL_ACK, seq, oid, e->side, e->price, uint32_t(gCancelQty));
-    e->alive = false;  // audit queries scan alive/remaining
+    e->alive = false;  // a later modify of this id is rejected
 }
 
 HOT_INLINE void onModify(const modify_t* m) {
+    if (gRecorder != nullptr) [[unlikely]] {
+        recordModify(m);
+    }
     const uint64_t seq = m->sequence_number;
     const uint64_t oid = m->order_id;
     const int64_t newPrice = m->new_price_ticks;
     const uint32_t newQty = m->new_quantity;
 
-    // The engine adjudicates the cancel half of cancel + reinsert: Rejected
-    // (never seen / already terminal) maps to ModifyReject.
-    gCancelOK = false;
-    gCancelQty = 0;
-    gBook->cancelOrder(oid);
-    if (!gCancelOK) [[unlikely]] {
+    // The ack must precede the modify's trades on the wire, but modifyOrder
+    // only reports Replaced from inside the call. A live shadow entry is
+    // exactly the engine's precondition for Replaced (never seen / already
+    // terminal ids are Rejected), so the shadow decides the ack up front.
+    Shadow* e = shadowSlot(oid);
+    if (!e->alive) [[unlikely]] {
         emitAck(ME_MODIFY_REJECT, seq, oid, 0, 0, 0);
         return;
     }
 
-    Shadow* e = shadowSlot(oid);
     const uint8_t side = e->side;  // payload echo (report has no side)
-
     emitAck(ME_MODIFY_ACK, seq, oid, side, newPrice, newQty);
 
-    // Reinsert at the new price/quantity; its crossing fills emit ME_TRADE.
+    if (newQty == 0 || newPrice <= 0) [[unlikely]] {
+        // The engine rejects a zero qty/price amend and leaves the order
+        // resting; the harness contract (cancel + reinsert) removes it.
+        gBook->cancelOrder(oid);
+        e->remaining = 0;
+        e->alive = false;
+        return;
+    }
+
+    // Crossing fills emit ME_TRADE with this seq from inside modifyOrder.
     gCurSeq = seq;
     gTakerFill = 0;
+    gModifyOK = false;
 
-    const Side sideT = (side == 0) ? Side::Buy : Side::Sell;
-    gBook->addOrder(oid, Type::Limit, sideT, toDecQty(newQty), toDecPrice(newPrice), Flag::None);
+    gBook->modifyOrder(oid, toDecQty(newQty), toDecPrice(newPrice));
 
     const uint64_t filled = gTakerFill;
     const uint32_t residual = (filled < newQty) ? uint32_t(newQty - filled) : 0;
 
-    // The reinsert may have grown the shadow store (cold), so re-fetch the slot.
+    // Crossing fills may have grown the shadow store (cold), so re-fetch the slot.
     e = shadowSlot(oid);
     e->price = newPrice;
-    e->side = side;
     e->remaining = residual;
-    e->alive = (residual > 0);
+    e->alive = gModifyOK && (residual > 0);
+}
+
+// Prefetch view of a harness message: only the fields OrderBook::prefetch
+// reads (kind, id, and side/price for new orders) are filled in.
+HOT_INLINE orderbook::Command toCommand(const me_msg_t& m) {
+    orderbook::Command c;
+    switch (m.type) {
+        case 0:
+            c.kind = orderbook::CommandType::Add;
+            c.id = m.no.order_id;
+            c.side = (m.no.side == 0) ? Side::Buy : Side::Sell;
+            c.price = toDecPrice(m.no.price_ticks);
+            break;
+        case 1:
+            c.kind = orderbook::CommandType::Cancel;
+            c.id = m.c.order_id;
+            break;
+        default:
+            c.kind = orderbook::CommandType::Modify;
+            c.id = m.md.order_id;
+            break;
+    }
+    return c;
 }
 
 // ---------------------------------------------------------------------------
@@ -433,6 +508,7 @@ void engine_init(uint64_t /*seed*/, const me_transport_t* transport, void* repor
     gTakerFill = 0;
     gCancelOK = false;
     gCancelQty = 0;
+    gModifyOK = false;
 
     gShadow.assign(kShadowInit, Shadow{});
     gShadowBase = gShadow.data();
@@ -441,13 +517,25 @@ void engine_init(uint64_t /*seed*/, const me_transport_t* transport, void* repor
     delete gBook;
     // Generous pools: the canonical workload has up to ~millions of orders;
     // the AdaptiveObjectPool grows on demand so these are just initial sizes.
-    // Tick-indexed price levels (perf/lever-b prototype): harness prices are
-    // integer ticks with fp = tick * 1e8, tick range ~1..54400.
-    //   base_fp = 0, tick_fp = 1e8, num_ticks = 65536.
-    gBook = new OrderBook<HarnessNotification>(gNotification, 1 << 16, 1 << 21, 16384, /*base_fp=*/0, /*tick_fp=*/100000000, /*num_ticks=*/1 << 16);
+    // Tick-indexed price levels on a tick-unit grid: harness prices are
+    // integer ticks carried as fp = tick, tick range ~1..54400.
+    //   base_fp = 0, tick_fp = 1, num_ticks = 65536.
+    gBook = new OrderBook<HarnessNotification>(gNotification, 1 << 16, 1 << 21, 16384, /*base_fp=*/0, /*tick_fp=*/1, /*num_ticks=*/1 << 16);
+
+    delete gRecorder;
+    gRecorder = nullptr;
+    if (const char* path = std::getenv("ME_RECORD_PATH"); path != nullptr && *path != '\0') {
+        gRecorder = new orderbook::bench::ReplayWriter(path);
+        if (!gRecorder->ok()) {
+            delete gRecorder;
+            gRecorder = nullptr;
+        }
+    }
 }
 
 void engine_shutdown(void) {
+    delete gRecorder;  // flushes and closes the recording
+    gRecorder = nullptr;
     delete gBook;
     gBook = nullptr;
     gShadow.clear();
@@ -467,42 +555,17 @@ void engine_flush(void) {
 }
 
 int64_t engine_query_best_bid(void) {
-    int64_t best = INT64_MIN;
-    const Shadow* s = gShadowBase;
-    const size_t n = gShadowCap;
-    for (size_t i = 0; i < n; ++i) {
-        const Shadow& e = s[i];
-        if (e.alive && e.side == 0 && e.price > best) {
-            best = e.price;
-        }
-    }
-    return best;
+    const auto best = gBook->bestBid();
+    return best.empty() ? INT64_MIN : fromDecPrice(best.price);
 }
 
 int64_t engine_query_best_ask(void) {
-    int64_t best = INT64_MAX;
-    const Shadow* s = gShadowBase;
-    const size_t n = gShadowCap;
-    for (size_t i = 0; i < n; ++i) {
-        const Shadow& e = s[i];
-        if (e.alive && e.side == 1 && e.price < best) {
-            best = e.price;
-        }
-    }
-    return best;
+    const auto best = gBook->bestAsk();
+    return best.empty() ? INT64_MAX : fromDecPrice(best.price);
 }
 
 uint64_t engine_query_depth_at(int64_t price_ticks, uint8_t side) {
-    uint64_t total = 0;
-    const Shadow* s = gShadowBase;
-    const size_t n = gShadowCap;
-    for (size_t i = 0; i < n; ++i) {
-        const Shadow& e = s[i];
-        if (e.alive && e.side == side && e.price == price_ticks) {
-            total += e.remaining;
-        }
-    }
-    return total;
+    return fromDecQty(gBook->depthAt(side == 0 ? Side::Buy : Side::Sell, toDecPrice(price_ticks)));
 }
 
 const me_transport_t* engine_get_transport(void) {
@@ -511,7 +574,26 @@ const me_transport_t* engine_get_transport(void) {
 }
 
 void engine_on_batch(const me_msg_t* msgs, uint32_t n) {
-    for (uint32_t i = 0; i < n; ++i) {
+    // Same staged lookahead as OrderBook::processBatch: the per-message
+    // handlers still run one at a time (they synthesise acks around each engine
+    // call), but the index bucket -> node -> Order chain of the messages a few
+    // slots ahead is already in flight.
+    using Book = OrderBook<HarnessNotification>;
+    const auto count = static_cast<ptrdiff_t>(n);
+    for (ptrdiff_t i = -static_cast<ptrdiff_t>(Book::kPrefetchBucketAhead); i < count; ++i) {
+        if (const ptrdiff_t j = i + Book::kPrefetchBucketAhead; j >= 0 && j < count) {
+            gBook->prefetch(toCommand(msgs[j]), orderbook::PrefetchStage::Bucket);
+        }
+        if (const ptrdiff_t j = i + Book::kPrefetchNodeAhead; j >= 0 && j < count) {
+            gBook->prefetch(toCommand(msgs[j]), orderbook::PrefetchStage::Node);
+        }
+        if (const ptrdiff_t j = i + Book::kPrefetchOrderAhead; j >= 0 && j < count) {
+            gBook->prefetch(toCommand(msgs[j]), orderbook::PrefetchStage::Order);
+        }
+        if (i < 0) {
+            continue;
+        }
+
         const me_msg_t& m = msgs[i];
         switch (m.type) {
             case 0:
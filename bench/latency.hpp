@@ -0,0 +1,183 @@
+// latency.hpp — timing primitives shared by the benchmark tools: a TSC-based
+// cycle clock calibrated to nanoseconds, an HDR-style log-linear latency
+// histogram and the thread setup that precedes a timed run.
+#pragma once
+
+#include <sched.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "wait_strategy.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace orderbook::bench {
+
+// Cycle-counter clock. now() reads the TSC (steady_clock nanoseconds where
+// there is no TSC); toNanos() converts a difference of two readings using a
+// ticks-per-ns ratio measured once against steady_clock at construction.
+// start() fences so the timed code cannot begin before the read; stop() uses
+// rdtscp, which waits for the timed code to retire.
+class TscClock {
+   public:
+    TscClock() { calibrate(); }
+
+    static uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        const uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+#else
+        return steadyNanos();
+#endif
+    }
+
+    static uint64_t stop() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned aux;
+        const uint64_t t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+#else
+        return steadyNanos();
+#endif
+    }
+
+    [[nodiscard]] uint64_t toNanos(uint64_t ticks) const { return static_cast<uint64_t>(static_cast<double>(ticks) / ticks_per_ns_); }
+    [[nodiscard]] double ticksPerNano() const { return ticks_per_ns_; }
+
+   private:
+    static uint64_t steadyNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t c0 = start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const uint64_t c1 = stop();
+        const auto t1 = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        ticks_per_ns_ = static_cast<double>(c1 - c0) / ns;
+#endif
+    }
+
+    double ticks_per_ns_ = 1.0;
+};
+
+// HDR-style log-linear histogram of nanosecond values. Values below 2^kSubBits
+// get exact buckets; above that every power of two is split into 2^kSubBits
+// linear sub-buckets, so any recorded value is reported within 1/32 (~3%) of
+// its true value across the full uint64 range, in a fixed ~15 KiB of counters
+// and with no allocation on record().
+class LatencyHistogram {
+   public:
+    static constexpr unsigned kSubBits = 5;
+    static constexpr uint64_t kSub = uint64_t{1} << kSubBits;
+    static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSub;
+
+    void record(uint64_t v) {
+        ++counts_[bucketOf(v)];
+        ++total_;
+        sum_ += v;
+        min_ = std::min(min_, v);
+        max_ = std::max(max_, v);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    [[nodiscard]] uint64_t count() const { return total_; }
+    [[nodiscard]] uint64_t max() const { return total_ ? max_ : 0; }
+    [[nodiscard]] uint64_t min() const { return total_ ? min_ : 0; }
+    [[nodiscard]] double mean() const { return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) : 0.0; }
+
+    // Smallest recorded-bucket upper bound at or below which at least pct% of
+    // the values fall (clamped to the observed max).
+    [[nodiscard]] uint64_t percentile(double pct) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        const auto rank = static_cast<uint64_t>(pct / 100.0 * static_cast<double>(total_) + 0.5);
+        const uint64_t target = std::clamp<uint64_t>(rank, 1, total_);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                return std::min(upperBound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    // One line: count, mean and the tail percentiles, all in ns.
+    void print(std::ostream& os, const std::string& label) const {
+        os << std::left << std::setw(8) << label << std::right << " n=" << std::setw(10) << count() << "  mean=" << std::setw(8) << std::fixed
+           << std::setprecision(1) << mean() << "  p50=" << std::setw(7) << percentile(50) << "  p99=" << std::setw(7) << percentile(99)
+           << "  p99.9=" << std::setw(7) << percentile(99.9) << "  p99.99=" << std::setw(7) << percentile(99.99) << "  max=" << std::setw(9) << max()
+           << "  (ns)\n";
+    }
+
+    static size_t bucketOf(uint64_t v) {
+        if (v < kSub) {
+            return static_cast<size_t>(v);
+        }
+        const unsigned shift = 63 - __builtin_clzll(v) - kSubBits;  // v >> shift is in [kSub, 2 * kSub)
+        return static_cast<size_t>((shift + 1) * kSub + ((v >> shift) - kSub));
+    }
+
+    static uint64_t upperBound(size_t bucket) {
+        if (bucket < 2 * kSub) {
+            return bucket;
+        }
+        const unsigned shift = static_cast<unsigned>(bucket / kSub) - 1;
+        const uint64_t sub = bucket % kSub + kSub;
+        return ((sub + 1) << shift) - 1;
+    }
+
+   private:
+    std::array<uint64_t, kBuckets> counts_{};
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+// Pin the calling thread to cpu (cpu < 0 leaves it where it is) and, with
+// sched, move the process to SCHED_FIFO at top priority. A refusal only warns
+// on stderr; the run goes ahead with noisier numbers.
+inline void prepareTimedThread(int cpu, bool sched) {
+    if (cpu >= 0 && !pinCurrentThread(cpu)) {
+        std::cerr << "warning: could not pin to cpu " << cpu << std::endl;
+    }
+    if (sched) {
+        sched_param param{};
+        param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+        if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+            std::cerr << "warning: SCHED_FIFO not available: " << std::strerror(errno) << std::endl;
+        }
+    }
+}
+
+}  // namespace orderbook::bench
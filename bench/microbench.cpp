@@ -0,0 +1,562 @@
+// microbench.cpp — Google Benchmark cases for the engine's building blocks:
+// OrderQueue sweeps, both LevelStore backends, the order index, the object pool
+// and the full OrderBook add / cancel / cross paths. Cases are built to reach a
+// steady state inside the timed loop, so PauseTiming is only used where a case
+// must rebuild its fixture every iteration.
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "array_levels.hpp"
+#include "direct_index.hpp"
+#include "object_pool.hpp"
+#include "order.hpp"
+#include "order_index.hpp"
+#include "orderbook.hpp"
+#include "orderqueue.hpp"
+#include "rbtree_levels.hpp"
+#include "swiss_index.hpp"
+
+namespace {
+
+using namespace orderbook;
+
+constexpr uint64_t kTickFp = 100000000;  // 1.0 on the default grid
+constexpr size_t kGridTicks = 1 << 16;
+
+Decimal tickPrice(size_t tick) { return decimalFromFp(tick * kTickFp); }
+
+// --- OrderQueue ------------------------------------------------------------
+
+// process() sweeping `sweep` resting orders out of a queue of `len`. Each fully
+// filled maker is re-queued at the back from postFill with its quantity
+// restored, so the queue keeps its length and the next sweep starts from the
+// same shape.
+void BM_OrderQueueProcess(benchmark::State& state) {
+    const auto len = static_cast<size_t>(state.range(0));
+    const auto sweep = static_cast<size_t>(state.range(1));
+    const Decimal price(100, 0);
+    const Decimal qty(10, 0);
+
+    std::vector<Order> orders;
+    orders.reserve(len);
+    OrderQueue q(price);
+    for (size_t i = 0; i < len; ++i) {
+        orders.emplace_back(i, Type::Limit, Side::Sell, qty, price, Flag::None);
+        q.append(&orders.back());
+    }
+
+    uint64_t fills = 0;
+    const auto tn = [&fills](OrderID, OrderID, OrderStatus, OrderStatus, Decimal, Decimal) { ++fills; };
+    const auto pf = [&](OrderID id) {
+        Order* o = &orders[id];
+        q.remove(o);
+        o->qty = qty;
+        q.append(o);
+    };
+    const Decimal take = qty * Decimal(static_cast<int64_t>(sweep), 0);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(q.process(tn, pf, 0, take));
+    }
+    for (auto& o : orders) {
+        q.remove(&o);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(fills));
+}
+BENCHMARK(BM_OrderQueueProcess)->ArgsProduct({{16, 1024}, {1, 8, 16}});
+
+// --- LevelStore backends ---------------------------------------------------
+
+// A store populated on every `stride`-th tick of kGridTicks; density falls as
+// the stride grows. The query prices are a shuffled sample of all ticks.
+template <template <PriceType> class Levels, PriceType P>
+struct PopulatedLevels {
+    Levels<P> store;
+    std::vector<Decimal> queries;
+
+    explicit PopulatedLevels(size_t stride) : store(LevelStoreConfig{kGridTicks, 0, kTickFp, kGridTicks}) {
+        for (size_t t = 1; t < kGridTicks; t += stride) {
+            benchmark::DoNotOptimize(store.findOrCreate(tickPrice(t)));
+        }
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<size_t> tick(1, kGridTicks - 1);
+        queries.resize(4096);
+        for (auto& p : queries) {
+            p = tickPrice(tick(rng));
+        }
+    }
+};
+
+// Create a level between two occupied ones, then drop it again.
+template <template <PriceType> class Levels>
+void BM_LevelsFindOrCreateErase(benchmark::State& state) {
+    PopulatedLevels<Levels, PriceType::Bid> l(static_cast<size_t>(state.range(0)));
+    const Decimal gap = tickPrice(kGridTicks / 2);
+    if (OrderQueue* q = l.store.find(gap)) {
+        l.store.erase(q);
+    }
+    for (auto _ : state) {
+        OrderQueue* q = l.store.findOrCreate(gap);
+        benchmark::DoNotOptimize(q);
+        l.store.erase(q);
+    }
+}
+
+// Same, at the best price, so erase also has to find the next best level.
+template <template <PriceType> class Levels>
+void BM_LevelsEraseBest(benchmark::State& state) {
+    PopulatedLevels<Levels, PriceType::Bid> l(static_cast<size_t>(state.range(0)));
+    const Decimal top = tickPrice(kGridTicks - 1);
+    for (auto _ : state) {
+        OrderQueue* q = l.store.findOrCreate(top);
+        benchmark::DoNotOptimize(q);
+        l.store.erase(q);
+    }
+}
+
+template <template <PriceType> class Levels>
+void BM_LevelsBest(benchmark::State& state) {
+    PopulatedLevels<Levels, PriceType::Bid> l(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l.store.best());
+    }
+}
+
+template <template <PriceType> class Levels>
+void BM_LevelsBelow(benchmark::State& state) {
+    PopulatedLevels<Levels, PriceType::Bid> l(static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l.store.below(l.queries[i++ & 4095]));
+    }
+}
+
+template <template <PriceType> class Levels>
+void BM_LevelsAbove(benchmark::State& state) {
+    PopulatedLevels<Levels, PriceType::Ask> l(static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(l.store.above(l.queries[i++ & 4095]));
+    }
+}
+
+// Occupied every 1, 16, 256 and 4096 ticks: from a solid book to a sparse one.
+#define LEVELS_BENCHMARK(fn)                                  \
+    BENCHMARK_TEMPLATE(fn, ArrayLevels)->RangeMultiplier(16)->Range(1, 4096); \
+    BENCHMARK_TEMPLATE(fn, RbTreeLevels)->RangeMultiplier(16)->Range(1, 4096)
+
+LEVELS_BENCHMARK(BM_LevelsFindOrCreateErase);
+LEVELS_BENCHMARK(BM_LevelsEraseBest);
+LEVELS_BENCHMARK(BM_LevelsBest);
+LEVELS_BENCHMARK(BM_LevelsBelow);
+LEVELS_BENCHMARK(BM_LevelsAbove);
+
+// --- Order index ----------------------------------------------------------
+
+// The index never dereferences its values, so one pooled dummy order stands in
+// for all (the compact index stores its pool handle).
+pool::ObjectPool<Order>& dummyPool() {
+    static pool::ObjectPool<Order> p(1);
+    return p;
+}
+
+Order* dummyOrder() {
+    static Order* o = dummyPool().acquire(0, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+    return o;
+}
+
+// Erase the oldest id and insert a fresh one, holding the index at `size`
+// entries with monotonically increasing ids, as a live book does. Erasing
+// first keeps the node pool within its reserve.
+template <class Index>
+void BM_IndexInsertErase(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    Index idx(dummyPool(), size);
+    for (uint64_t id = 1; id <= size; ++id) {
+        idx.insert(id, dummyOrder());
+    }
+    uint64_t next = size + 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(idx.erase(next - size));
+        idx.insert(next, dummyOrder());
+        ++next;
+    }
+}
+
+template <class Index>
+void BM_IndexFind(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    Index idx(dummyPool(), size);
+    for (uint64_t id = 1; id <= size; ++id) {
+        idx.insert(id, dummyOrder());
+    }
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<uint64_t> pick(1, size);
+    std::vector<uint64_t> ids(4096);
+    for (auto& id : ids) {
+        id = pick(rng);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(idx.find(ids[i++ & 4095]));
+    }
+}
+
+template <class Index>
+void BM_IndexFindMiss(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    Index idx(dummyPool(), size);
+    for (uint64_t id = 1; id <= size; ++id) {
+        idx.insert(id, dummyOrder());
+    }
+    uint64_t miss = size + 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(idx.find(miss++));
+    }
+}
+
+// Fill an index reserved for 16 entries up to `size`, paying for every
+// doubling on the way; reported per inserted entry.
+template <class Index>
+void BM_IndexGrowWithRehash(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    for (auto _ : state) {
+        Index idx(dummyPool(), 16);
+        for (uint64_t id = 1; id <= size; ++id) {
+            idx.insert(id, dummyOrder());
+        }
+        benchmark::DoNotOptimize(idx.size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+
+// The same fill as BM_IndexGrowWithRehash, timing each insert on its own;
+// max_insert_ns is the worst one, which for a one-shot rehash is the insert
+// that re-links the whole table.
+template <class Index>
+void BM_IndexGrowthStall(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    double worst = 0;
+    for (auto _ : state) {
+        Index idx(dummyPool(), 16);
+        for (uint64_t id = 1; id <= size; ++id) {
+            const auto t0 = std::chrono::steady_clock::now();
+            idx.insert(id, dummyOrder());
+            const auto t1 = std::chrono::steady_clock::now();
+            worst = std::max(worst, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        }
+        benchmark::DoNotOptimize(idx.size());
+    }
+    state.counters["max_insert_ns"] = worst;
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+
+// A single reserve() of an index already holding `size` entries.
+template <class Index>
+void BM_IndexReserve(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto idx = std::make_unique<Index>(dummyPool(), size);
+        for (uint64_t id = 1; id <= size; ++id) {
+            idx->insert(id, dummyOrder());
+        }
+        state.ResumeTiming();
+        idx->reserve(size * 4);
+        benchmark::DoNotOptimize(idx->size());
+        state.PauseTiming();
+        idx.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+
+// Every case runs against each index policy.
+#define INDEX_BENCHMARK(fn)                                                                              \
+    BENCHMARK_TEMPLATE(fn, index::FibHashIndex)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);            \
+    BENCHMARK_TEMPLATE(fn, index::CompactFibHashIndex)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);     \
+    BENCHMARK_TEMPLATE(fn, index::IncrementalFibHashIndex)->RangeMultiplier(16)->Range(1 << 8, 1 << 20); \
+    BENCHMARK_TEMPLATE(fn, index::SwissIndex)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);              \
+    BENCHMARK_TEMPLATE(fn, index::DirectIndex)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)
+
+INDEX_BENCHMARK(BM_IndexInsertErase);
+INDEX_BENCHMARK(BM_IndexFind);
+INDEX_BENCHMARK(BM_IndexFindMiss);
+INDEX_BENCHMARK(BM_IndexGrowWithRehash);
+INDEX_BENCHMARK(BM_IndexReserve);
+INDEX_BENCHMARK(BM_IndexGrowthStall);
+
+// BM_IndexGrowthStall counting only inserts whose node pool did not allocate
+// a slab, so the worst insert is down to the bucket array (a SlabGrower takes
+// the slabs off the inserting thread in a book). max_insert_ns is the worst
+// such insert of a fill, averaged over fills: it grows with size for a
+// one-shot rehash and stays flat for the incremental index, whose doubled
+// array is cleared ahead of time.
+template <class Index>
+void BM_IndexGrowthStallBuckets(benchmark::State& state) {
+    const auto size = static_cast<uint64_t>(state.range(0));
+    double worst_sum = 0;
+    for (auto _ : state) {
+        Index idx(dummyPool(), 16);
+        double worst = 0;
+        for (uint64_t id = 1; id <= size; ++id) {
+            const size_t slabs = idx.slabs();
+            const auto t0 = std::chrono::steady_clock::now();
+            idx.insert(id, dummyOrder());
+            const auto t1 = std::chrono::steady_clock::now();
+            if (idx.slabs() == slabs) {
+                worst = std::max(worst, std::chrono::duration<double, std::nano>(t1 - t0).count());
+            }
+        }
+        worst_sum += worst;
+        benchmark::DoNotOptimize(idx.size());
+    }
+    state.counters["max_insert_ns"] = benchmark::Counter(worst_sum, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK_TEMPLATE(BM_IndexGrowthStallBuckets, index::FibHashIndex)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_IndexGrowthStallBuckets, index::IncrementalFibHashIndex)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// --- ObjectPool ------------------------------------------------------------
+
+void BM_PoolAcquireRelease(benchmark::State& state) {
+    pool::ObjectPool<Order> p(1024);
+    for (auto _ : state) {
+        Order* o = p.acquire(1, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+        benchmark::DoNotOptimize(o);
+        p.release(o);
+    }
+}
+BENCHMARK(BM_PoolAcquireRelease);
+
+// `burst` acquires then `burst` releases, so the free list is walked deep and
+// recycled in LIFO order; reported per acquire/release pair.
+void BM_PoolBurst(benchmark::State& state) {
+    const auto burst = static_cast<size_t>(state.range(0));
+    pool::ObjectPool<Order> p(burst);
+    std::vector<Order*> held(burst);
+    for (auto _ : state) {
+        for (size_t i = 0; i < burst; ++i) {
+            held[i] = p.acquire(i, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+        }
+        benchmark::DoNotOptimize(held.data());
+        for (size_t i = 0; i < burst; ++i) {
+            p.release(held[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(burst));
+}
+BENCHMARK(BM_PoolBurst)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// Read a random live order out of `size` held in one pool, as cancels and
+// amends across a deep book do: beyond the caches this is bound by page walks,
+// which huge-page slabs cut down.
+template <pool::SlabPolicy::Pages Pages>
+void BM_PoolRandomAccess(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    pool::ObjectPool<Order> p(size, pool::SlabPolicy{.pages = Pages, .prefault = true});
+    std::vector<Order*> held(size);
+    for (size_t i = 0; i < size; ++i) {
+        held[i] = p.acquire(i, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+    }
+    std::mt19937_64 rng(3);
+    std::vector<Order*> picks(4096);
+    for (auto& o : picks) {
+        o = held[rng() % size];
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(picks[i++ & 4095]->qty);
+    }
+    for (auto* o : held) {
+        p.release(o);
+    }
+}
+BENCHMARK_TEMPLATE(BM_PoolRandomAccess, pool::SlabPolicy::Pages::Default)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PoolRandomAccess, pool::SlabPolicy::Pages::Transparent)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// Fill a pool from a 16-slot first slab to `size` objects, with a little work
+// between acquires the way a book has between orders. max_acquire_ns is the
+// worst acquire: with prefaulted slabs allocated inline, the one that maps and
+// threads the largest slab; with a SlabGrower, whatever is left.
+template <bool Grower>
+void BM_PoolGrowthStall(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    pool::SlabGrower grower;
+    const pool::SlabPolicy policy{.prefault = true, .grower = Grower ? &grower : nullptr};
+    std::vector<Order*> held(size);
+    double worst = 0;
+    size_t stalls = 0;
+    for (auto _ : state) {
+        pool::ObjectPool<Order> p(16, policy);
+        for (size_t i = 0; i < size; ++i) {
+            const auto t0 = std::chrono::steady_clock::now();
+            held[i] = p.acquire(i, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+            const auto t1 = std::chrono::steady_clock::now();
+            worst = std::max(worst, std::chrono::duration<double, std::nano>(t1 - t0).count());
+            for (int k = 0; k < 64; ++k) {
+                benchmark::DoNotOptimize(k);
+            }
+        }
+        stalls += p.stalls();
+        for (auto* o : held) {
+            p.release(o);
+        }
+    }
+    state.counters["max_acquire_ns"] = worst;
+    state.counters["stalls"] = benchmark::Counter(static_cast<double>(stalls), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK_TEMPLATE(BM_PoolGrowthStall, false)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PoolGrowthStall, true)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// trim() after a pool of `size` objects drains back to its first slab: one
+// whole pass over the free list plus unmapping every other slab.
+void BM_PoolTrim(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    std::vector<Order*> held(size);
+    for (auto _ : state) {
+        state.PauseTiming();
+        pool::ObjectPool<Order> p(1024);
+        for (size_t i = 0; i < size; ++i) {
+            held[i] = p.acquire(i, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+        }
+        for (size_t i = 1024; i < size; ++i) {
+            p.release(held[i]);
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(p.trim());
+        state.PauseTiming();
+        for (size_t i = 0; i < 1024; ++i) {
+            p.release(held[i]);
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(BM_PoolTrim)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// The same drain trimmed in steps of at most 4096 slots. max_call_ns, the
+// slowest trim() call of a drain averaged over drains, is the walk of one
+// step plus unmapping whatever slab it empties, not the whole free list; at
+// 1M the largest slab's munmap dominates it.
+void BM_PoolTrimSteps(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    std::vector<Order*> held(size);
+    double worst_sum = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        pool::ObjectPool<Order> p(1024);
+        for (size_t i = 0; i < size; ++i) {
+            held[i] = p.acquire(i, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+        }
+        for (size_t i = 1024; i < size; ++i) {
+            p.release(held[i]);
+        }
+        state.ResumeTiming();
+        double worst = 0;
+        do {
+            const auto t0 = std::chrono::steady_clock::now();
+            benchmark::DoNotOptimize(p.trim(0, 4096));
+            const auto t1 = std::chrono::steady_clock::now();
+            worst = std::max(worst, std::chrono::duration<double, std::nano>(t1 - t0).count());
+        } while (p.trimming());
+        worst_sum += worst;
+        state.PauseTiming();
+        for (size_t i = 0; i < 1024; ++i) {
+            p.release(held[i]);
+        }
+        state.ResumeTiming();
+    }
+    state.counters["max_call_ns"] = benchmark::Counter(worst_sum, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(BM_PoolTrimSteps)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// --- OrderBook -------------------------------------------------------------
+
+// A book holding `depth` resting orders a side, one per tick, bids below 1000
+// and asks above it. Ids of the resting orders are 1..2*depth.
+template <template <PriceType> class Levels>
+struct DeepBook {
+    EmptyNotification n;
+    OrderBook<EmptyNotification, Levels> book;
+    OrderID next_id = 1;
+
+    explicit DeepBook(size_t depth) : book(n, 16384, 1 << 20, 1 << 20, 0, kTickFp, kGridTicks) {
+        for (size_t i = 0; i < depth; ++i) {
+            const size_t off = i % 500 + 1;
+            book.addOrder(next_id++, Type::Limit, Side::Buy, Decimal(10, 0), tickPrice(1000 - off), Flag::None);
+            book.addOrder(next_id++, Type::Limit, Side::Sell, Decimal(10, 0), tickPrice(1000 + off), Flag::None);
+        }
+    }
+};
+
+// Rest an order a few ticks inside the book, then cancel it.
+template <template <PriceType> class Levels>
+void BM_BookAddCancel(benchmark::State& state) {
+    DeepBook<Levels> b(static_cast<size_t>(state.range(0)));
+    size_t i = 0;
+    for (auto _ : state) {
+        const OrderID id = b.next_id++;
+        b.book.addOrder(id, Type::Limit, Side::Buy, Decimal(1, 0), tickPrice(1000 - (i++ & 7) - 1), Flag::None);
+        b.book.cancelOrder(id);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Rest a sell at 1000 and take it out with an IoC buy: a full maker fill that
+// creates and erases the level each time.
+template <template <PriceType> class Levels>
+void BM_BookCross(benchmark::State& state) {
+    DeepBook<Levels> b(static_cast<size_t>(state.range(0)));
+    const Decimal px = tickPrice(1000);
+    for (auto _ : state) {
+        b.book.addOrder(b.next_id++, Type::Limit, Side::Sell, Decimal(5, 0), px, Flag::None);
+        b.book.addOrder(b.next_id++, Type::Limit, Side::Buy, Decimal(5, 0), px, Flag::IoC);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Keep `quotes` resting bids and reprice a random one per iteration, by id or
+// through the OrderHandle addOrder returned for it.
+template <template <PriceType> class Levels, bool ByHandle>
+void BM_BookRequote(benchmark::State& state) {
+    const auto quotes = static_cast<size_t>(state.range(0));
+    DeepBook<Levels> b(16);
+    std::vector<OrderHandle> handles;
+    for (size_t i = 0; i < quotes; ++i) {
+        handles.push_back(b.book.addOrder(b.next_id++, Type::Limit, Side::Buy, Decimal(1, 0), tickPrice(900 - i % 64), Flag::None, with_handle));
+    }
+    std::mt19937_64 rng(11);
+    std::vector<uint32_t> picks(4096);
+    for (auto& p : picks) {
+        p = static_cast<uint32_t>(rng() % quotes);
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        const OrderHandle& h = handles[picks[i & 4095]];
+        const Decimal px = tickPrice(900 - (++i % 64));
+        if constexpr (ByHandle) {
+            b.book.modifyOrder(h, Decimal(1, 0), px);
+        } else {
+            b.book.modifyOrder(h.id, Decimal(1, 0), px);
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_BookAddCancel, ArrayLevels)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BookAddCancel, RbTreeLevels)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BookCross, ArrayLevels)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BookCross, RbTreeLevels)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_BookRequote, ArrayLevels, false)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BookRequote, ArrayLevels, true)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,165 @@
+// replay.cpp — drives an OrderBook from a recorded replay file (see
+// replay_file.hpp), either as fast as possible or paced by the recorded
+// timestamps, and reports throughput, per-command latency and a checksum of the
+// final book.
+//
+//   replay -f FILE [-paced] [-speed X] [-tick_fp T] [-ticks N] [-cpu C] [-sched]
+//
+// -paced holds each command back until its recorded offset from the first
+// record (divided by -speed) has elapsed, so bursts and gaps arrive as they were
+// captured; without it records are applied back to back. -tick_fp (the tick's
+// raw fixed-point value) and -ticks size the book's price grid; the defaults
+// match the bench adapter's tick-unit grid: 1 and 65536. The
+// checksum is FNV-1a over the book's binary snapshot, so two runs of the same
+// file agree exactly when their final books hold the same orders in the same
+// queue positions.
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "latency.hpp"
+#include "orderbook.hpp"
+#include "replay_file.hpp"
+#include "wait_strategy.hpp"
+
+using orderbook::CommandType;
+using orderbook::bench::LatencyHistogram;
+using orderbook::bench::ReplayReader;
+using orderbook::bench::ReplayRecord;
+using orderbook::bench::TscClock;
+
+namespace {
+
+std::string getCmdOption(char** begin, char** end, const std::string& option, const std::string& default_value = "") {
+    char** itr = std::find(begin, end, option);
+    if (itr != end && ++itr != end) {
+        return *itr;
+    }
+    return default_value;
+}
+
+bool cmdOptionExists(char** begin, char** end, const std::string& option) { return std::find(begin, end, option) != end; }
+
+// Counts what the book reports; nothing else leaves the book.
+class CountingNotification : public orderbook::NotificationInterface<CountingNotification> {
+   public:
+    void onNew(const orderbook::OrderReport&) {}
+    void onCancel(const orderbook::OrderReport&) {}
+    void onReplace(const orderbook::OrderReport&) {}
+    void onReject(const orderbook::RejectReport&) { ++rejects; }
+    void onTrade(const orderbook::TradeReport&) { ++trades; }
+    void onExecutionReport(const orderbook::ExecutionReport&) {}
+
+    uint64_t trades = 0;
+    uint64_t rejects = 0;
+};
+
+using Book = orderbook::OrderBook<CountingNotification>;
+
+uint64_t bookChecksum(Book& book) {
+    std::ostringstream os;
+    book.saveSnapshot(os);
+    const std::string bytes = os.str();
+    uint64_t h = 14695981039346656037ull;
+    for (const unsigned char c : bytes) {
+        h = (h ^ c) * 1099511628211ull;
+    }
+    return h;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string path = getCmdOption(argv, argv + argc, "-f");
+    const bool paced = cmdOptionExists(argv, argv + argc, "-paced");
+    const double speed = std::stod(getCmdOption(argv, argv + argc, "-speed", "1.0"));
+    const uint64_t tick_fp = std::stoull(getCmdOption(argv, argv + argc, "-tick_fp", "1"));
+    const size_t ticks = std::stoull(getCmdOption(argv, argv + argc, "-ticks", "65536"));
+    const int cpu = std::stoi(getCmdOption(argv, argv + argc, "-cpu", "-1"));
+    const bool sched = cmdOptionExists(argv, argv + argc, "-sched");
+
+    if (path.empty() || speed <= 0 || tick_fp == 0) {
+        std::cerr << "usage: replay -f FILE [-paced] [-speed X] [-tick_fp T] [-ticks N] [-cpu C] [-sched]" << std::endl;
+        return 2;
+    }
+
+    ReplayReader reader(path);
+    if (!reader.ok()) {
+        std::cerr << "error: " << path << " is not a readable replay file" << std::endl;
+        return 1;
+    }
+    const auto records = reader.records();
+
+    orderbook::bench::prepareTimedThread(cpu, sched);
+
+    TscClock clock;
+    CountingNotification n;
+    auto book = std::make_unique<Book>(n, 1 << 16, 1 << 21, 1 << 16, /*base_fp=*/0, /*tick_fp=*/tick_fp, /*num_ticks=*/ticks);
+
+    LatencyHistogram addHist, cancelHist, modifyHist, allHist, lagHist;
+    LatencyHistogram* byKind[] = {&addHist, &cancelHist, &modifyHist};
+
+    const uint64_t first_ts = records.empty() ? 0 : records.front().ts_ns;
+    const auto wall_start = std::chrono::steady_clock::now();
+    for (const ReplayRecord& r : records) {
+        if (paced) {
+            const auto due = wall_start + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(r.ts_ns - first_ts) / speed));
+            auto now = std::chrono::steady_clock::now();
+            while (now < due) {
+                orderbook::cpuRelax();
+                now = std::chrono::steady_clock::now();
+            }
+            lagHist.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count()));
+        }
+
+        const orderbook::Command cmd = orderbook::bench::toCommand(r);
+        const uint64_t t0 = TscClock::start();
+        book->apply(cmd);
+        const uint64_t t1 = TscClock::stop();
+
+        const uint64_t ns = clock.toNanos(t1 - t0);
+        allHist.record(ns);
+        if (r.kind <= static_cast<uint8_t>(CommandType::Modify)) {
+            byKind[r.kind]->record(ns);
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    const double captured = records.empty() ? 0.0 : static_cast<double>(records.back().ts_ns - first_ts) / 1e9;
+    std::cout << "file:       " << path << " (" << records.size() << " records, " << std::fixed << std::setprecision(3) << captured
+              << " s captured)\n";
+    std::cout << "mode:       " << (paced ? "paced" : "as fast as possible");
+    if (paced) {
+        std::cout << " x" << speed;
+    }
+    std::cout << "\n";
+    std::cout << "replayed:   " << std::setprecision(3) << elapsed << " s, " << std::setprecision(2)
+              << (elapsed > 0 ? static_cast<double>(records.size()) / elapsed / 1e6 : 0.0) << " M msgs/s\n";
+    std::cout << "reports:    " << n.trades << " trades, " << n.rejects << " rejects\n";
+    std::cout << "latency:\n";
+    addHist.print(std::cout, "add");
+    cancelHist.print(std::cout, "cancel");
+    modifyHist.print(std::cout, "modify");
+    allHist.print(std::cout, "all");
+    if (paced) {
+        lagHist.print(std::cout, "lag");
+    }
+
+    const auto printBest = [](const char* label, const auto& best) {
+        std::cout << label;
+        if (best.empty()) {
+            std::cout << "-";
+        } else {
+            std::cout << best.price << " (fp " << best.price.fp << ")";
+        }
+    };
+    printBest("book:       best bid ", book->bestBid());
+    printBest(", best ask ", book->bestAsk());
+    std::cout << "\n";
+    std::cout << "checksum:   0x" << std::hex << std::setw(16) << std::setfill('0') << bookChecksum(*book) << std::dec << std::endl;
+    return 0;
+}
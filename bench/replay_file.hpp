@@ -0,0 +1,211 @@
+// replay_file.hpp — the binary command file read by the replay tool and written
+// by the bench adapter's recorder: a 64-byte header followed by fixed-size
+// timestamped add / cancel / modify records, in host byte order.
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace orderbook::bench {
+
+inline constexpr uint64_t kReplayMagic = 0x31594C5052424FULL;  // "OBRPLY1"
+inline constexpr uint32_t kReplayVersion = 1;
+
+struct ReplayHeader {
+    uint64_t magic = kReplayMagic;
+    uint32_t version = kReplayVersion;
+    uint32_t record_size = 0;
+    uint8_t reserved[48] = {};
+};
+static_assert(sizeof(ReplayHeader) == 64);
+
+// One engine command as it arrived. ts_ns is a steady-clock capture time; only
+// differences between records are meaningful. seq is the source's own sequence
+// number (the harness seq for adapter recordings), carried for cross-reference.
+struct ReplayRecord {
+    uint64_t ts_ns;
+    uint64_t seq;
+    uint64_t id;
+    uint64_t qty;    // Decimal fixed-point value
+    uint64_t price;  // Decimal fixed-point value
+    uint8_t kind;
+    uint8_t type;
+    uint8_t side;
+    uint8_t flag;
+    uint32_t reserved;
+};
+static_assert(sizeof(ReplayRecord) == 48);
+
+inline ReplayRecord toReplayRecord(uint64_t ts_ns, uint64_t seq, const Command& cmd) {
+    return {
+        .ts_ns = ts_ns,
+        .seq = seq,
+        .id = cmd.id,
+        .qty = cmd.qty.fp,
+        .price = cmd.price.fp,
+        .kind = static_cast<uint8_t>(cmd.kind),
+        .type = static_cast<uint8_t>(cmd.type),
+        .side = static_cast<uint8_t>(cmd.side),
+        .flag = static_cast<uint8_t>(cmd.flag),
+        .reserved = 0,
+    };
+}
+
+inline Command toCommand(const ReplayRecord& r) {
+    return {
+        .kind = static_cast<CommandType>(r.kind),
+        .type = static_cast<Type>(r.type),
+        .side = static_cast<Side>(r.side),
+        .flag = static_cast<Flag>(r.flag),
+        .id = r.id,
+        .qty = decimalFromFp(r.qty),
+        .price = decimalFromFp(r.price),
+    };
+}
+
+inline uint64_t replayNow() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Appends records to a new file (an existing one is truncated). Records are
+// buffered and written kBuffer at a time, so append() is a copy on the caller's
+// thread except once per kBuffer records.
+class ReplayWriter {
+   public:
+    static constexpr size_t kBuffer = 4096;
+
+    explicit ReplayWriter(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return;
+        }
+        ReplayHeader header;
+        header.record_size = sizeof(ReplayRecord);
+        if (!writeAll(fd, &header, sizeof(header))) {
+            ::close(fd);
+            return;
+        }
+        fd_ = fd;
+        buffer_.reserve(kBuffer);
+    }
+
+    ~ReplayWriter() { close(); }
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    [[nodiscard]] bool ok() const { return fd_ >= 0; }
+
+    void append(const ReplayRecord& r) {
+        buffer_.push_back(r);
+        if (buffer_.size() == kBuffer) [[unlikely]] {
+            flush();
+        }
+    }
+
+    void append(uint64_t seq, const Command& cmd) { append(toReplayRecord(replayNow(), seq, cmd)); }
+
+    // Write out buffered records. A failed write closes the file; later
+    // appends are dropped and ok() turns false.
+    void flush() {
+        if (fd_ >= 0 && !buffer_.empty() && !writeAll(fd_, buffer_.data(), buffer_.size() * sizeof(ReplayRecord))) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        buffer_.clear();
+    }
+
+    // Flush and close. Idempotent.
+    void close() {
+        flush();
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+   private:
+    static bool writeAll(int fd, const void* buf, size_t len) {
+        const auto* p = static_cast<const char*>(buf);
+        while (len > 0) {
+            const ssize_t n = ::write(fd, p, len);
+            if (n < 0) {
+                return false;
+            }
+            p += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    std::vector<ReplayRecord> buffer_;
+};
+
+// Maps a replay file read-only. The mapping is populated up front so a replay
+// takes no page faults on the record stream. A trailing partial record (a
+// recorder that died mid-write) is ignored.
+class ReplayReader {
+   public:
+    explicit ReplayReader(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ReplayHeader)) {
+            ::close(fd);
+            return;
+        }
+
+        const auto size = static_cast<size_t>(st.st_size);
+        void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            return;
+        }
+
+        ReplayHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (header.magic != kReplayMagic || header.version != kReplayVersion || header.record_size != sizeof(ReplayRecord)) {
+            ::munmap(base, size);
+            return;
+        }
+
+        const auto* first = reinterpret_cast<const ReplayRecord*>(static_cast<const char*>(base) + sizeof(ReplayHeader));
+        records_ = std::span<const ReplayRecord>(first, (size - sizeof(ReplayHeader)) / sizeof(ReplayRecord));
+        base_ = base;
+        mapped_ = size;
+    }
+
+    ~ReplayReader() {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_);
+        }
+    }
+
+    ReplayReader(const ReplayReader&) = delete;
+    ReplayReader& operator=(const ReplayReader&) = delete;
+
+    [[nodiscard]] bool ok() const { return base_ != nullptr; }
+    [[nodiscard]] std::span<const ReplayRecord> records() const { return records_; }
+
+   private:
+    void* base_ = nullptr;
+    size_t mapped_ = 0;
+    std::span<const ReplayRecord> records_;
+};
+
+}  // namespace orderbook::bench
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -16,11 +17,60 @@ namespace orderbook {
 namespace detail {
 // Round x up to the next multiple of 64 and divide by 64 (number of words).
 inline size_t words_for(size_t bits) { return (bits + 63) / 64; }
+
+// Division by the book's fixed tick size without a divide instruction. With
+// tick = odd * 2^shift, a multiple of tick is divided exactly by shifting out
+// 2^shift and multiplying by the inverse of odd mod 2^64, and that same product
+// is <= UINT64_MAX / odd exactly when the dividend was a multiple. Prices on
+// the grid, i.e. every price the book stores, therefore never divide; only
+// below() / above() queries for off-grid prices fall back to a real division.
+class TickDivider {
+   public:
+    explicit TickDivider(uint64_t tick) : tick_(tick) {
+        const unsigned shift = tick ? static_cast<unsigned>(__builtin_ctzll(tick)) : 0;
+        const uint64_t odd = tick >> shift;
+        uint64_t inv = odd;  // correct to 3 bits; each Newton step doubles that
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - odd * inv;
+        }
+        shift_ = shift;
+        low_mask_ = (uint64_t{1} << shift) - 1;
+        inverse_ = inv;
+        limit_ = odd ? UINT64_MAX / odd : 0;
+    }
+
+    // n / tick for n a multiple of tick.
+    [[nodiscard]] uint64_t exact(uint64_t n) const { return (n >> shift_) * inverse_; }
+
+    // true and q = n / tick when n is a multiple of tick.
+    [[nodiscard]] bool divides(uint64_t n, uint64_t& q) const {
+        q = exact(n);
+        return (n & low_mask_) == 0 && q <= limit_;
+    }
+
+    [[nodiscard]] uint64_t floor(uint64_t n) const {
+        uint64_t q;
+        return divides(n, q) ? q : n / tick_;
+    }
+
+    [[nodiscard]] uint64_t ceil(uint64_t n) const {
+        uint64_t q;
+        return divides(n, q) ? q : n / tick_ + 1;
+    }
+
+   private:
+    uint64_t tick_;
+    uint64_t inverse_ = 0;
+    uint64_t limit_ = 0;
+    uint64_t low_mask_ = 0;
+    unsigned shift_ = 0;
+};
 }  // namespace detail
 
 // LevelStore backend: tick-indexed array + 3-level occupancy bitmap.
 //
-// Each price maps to a fixed slot index = (price.fp - base_fp) / tick_fp.
+// Each price maps to a fixed slot index = (price.fp - base_fp) / tick_fp,
+// computed with a multiply rather than a division (detail::TickDivider).
 // levels_[slot] is the OrderQueue at that price (nullptr == empty). A 3-level
 // uint64 bitmap tracks which slots are occupied so best-price / neighbour
 // queries are O(1)-ish via hardware bit-scan instead of an O(log N) tree walk.
@@ -35,6 +85,7 @@ class ArrayLevels {
 
     uint64_t base_fp_ = 0;
     uint64_t tick_fp_ = 1;
+    detail::TickDivider ticks_{1};
     size_t num_ticks_ = 0;
 
     // Slot array: levels_[tickIndex(price)] -> OrderQueue* (nullptr == empty).
@@ -46,6 +97,12 @@ class ArrayLevels {
     std::vector<uint64_t> l0_;
 
     uint64_t depth_ = 0;
+    std::atomic<uint64_t> grows_{0};
+
+    // Cached best tick (highest for bids, lowest for asks), -1 when empty. Kept
+    // current by findOrCreate / erase so best() is a single load instead of a
+    // bitmap scan; only erasing the best level itself rescans, from that tick.
+    int best_ = -1;
 
     // --- tick math -----------------------------------------------------------
     [[nodiscard]] size_t tickIndex(const Decimal& price) const {
@@ -54,13 +111,14 @@ class ArrayLevels {
         // current capacity are handled by grow() rather than crashing.
         assert(fp >= base_fp_ && "price below tick grid base");
         const uint64_t delta = fp - base_fp_;
-        assert(delta % tick_fp_ == 0 && "price not tick-aligned");
-        return static_cast<size_t>(delta / tick_fp_);
+        assert(onGrid(price) && "price not tick-aligned");
+        return static_cast<size_t>(ticks_.exact(delta));
     }
 
     // Enlarge levels_ and the 3-level bitmap so that tick `needed_index` is in
     // range. Amortized O(1).
     void grow(size_t needed_index) {
+        grows_.store(grows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
         size_t new_cap = std::max(needed_index + 1, levels_.size() * 2);
         new_cap = (new_cap + 63) & ~static_cast<size_t>(63);  // round up to multiple of 64
 
@@ -123,11 +181,6 @@ class ArrayLevels {
         l0_[w0] &= ~b0;
     }
 
-    // Highest occupied tick, or -1 if the bitmap is empty.
-    [[nodiscard]] int highestSet() const { return highestSetBelow(static_cast<int>(num_ticks_)); }
-    // Lowest occupied tick, or -1 if the bitmap is empty.
-    [[nodiscard]] int lowestSet() const { return lowestSetAbove(-1); }
-
     // Highest occupied tick strictly below t, or -1.
     [[nodiscard]] int highestSetBelow(int t) const {
         if (t <= 0) {
@@ -238,7 +291,7 @@ class ArrayLevels {
 
    public:
     explicit ArrayLevels(const LevelStoreConfig& cfg)
-        : queue_pool_(cfg.pool_size), base_fp_(cfg.base_fp), tick_fp_(cfg.tick_fp), num_ticks_(cfg.num_ticks) {
+        : queue_pool_(cfg.pool_size, cfg.pool_slabs), base_fp_(cfg.base_fp), tick_fp_(cfg.tick_fp), ticks_(cfg.tick_fp), num_ticks_(cfg.num_ticks) {
         assert(tick_fp_ != 0 && "tick_fp must be non-zero");
         assert(num_ticks_ <= (size_t{64} * 64 * 64) && "num_ticks exceeds 3-level bitmap capacity");
 
@@ -253,16 +306,10 @@ class ArrayLevels {
     }
 
     [[nodiscard]] OrderQueue* best() {
-        int t;
-        if constexpr (P == PriceType::Bid) {
-            t = highestSet();
-        } else {
-            t = lowestSet();
-        }
-        if (t < 0) {
+        if (best_ < 0) {
             return nullptr;
         }
-        return levels_[static_cast<size_t>(t)];
+        return levels_[static_cast<size_t>(best_)];
     }
 
     [[nodiscard]] OrderQueue* findOrCreate(const Decimal& price) {
@@ -276,6 +323,30 @@ class ArrayLevels {
             levels_[t] = q;
             setBit(t);
             ++depth_;
+            const int ti = static_cast<int>(t);
+            if constexpr (P == PriceType::Bid) {
+                if (ti > best_) {
+                    best_ = ti;
+                }
+            } else {
+                if (best_ < 0 || ti < best_) {
+                    best_ = ti;
+                }
+            }
+        }
+        return q;
+    }
+
+    // Level at price, or nullptr if none (no creation). Prices off the grid or
+    // beyond capacity simply have no level.
+    [[nodiscard]] OrderQueue* find(const Decimal& price) {
+        size_t t;
+        if (!slotOf(price, t)) {
+            return nullptr;
+        }
+        OrderQueue* q = levels_[t];
+        if (q == nullptr || q->price() != price) {
+            return nullptr;
         }
         return q;
     }
@@ -286,6 +357,13 @@ class ArrayLevels {
         queue_pool_.release(q);
         levels_[t] = nullptr;
         --depth_;
+        if (static_cast<int>(t) == best_) {
+            if constexpr (P == PriceType::Bid) {
+                best_ = highestSetBelow(best_);
+            } else {
+                best_ = lowestSetAbove(best_);
+            }
+        }
     }
 
     // Highest occupied level whose price is strictly < the query price.
@@ -297,7 +375,7 @@ class ArrayLevels {
             return nullptr;
         }
         const uint64_t delta = fp - base_fp_;
-        const uint64_t ceil_idx = (delta + tick_fp_ - 1) / tick_fp_;  // first tick with price >= query
+        const uint64_t ceil_idx = ticks_.ceil(delta);  // first tick with price >= query
         const int t = highestSetBelow(static_cast<int>(ceil_idx));
         if (t < 0) {
             return nullptr;
@@ -311,7 +389,7 @@ class ArrayLevels {
         // so the last tick at or below the query is floor((fp - base)/tick).
         const uint64_t fp = price.fp;
         const uint64_t delta = (fp >= base_fp_) ? (fp - base_fp_) : 0;
-        const uint64_t floor_idx = delta / tick_fp_;  // last tick with price <= query
+        const uint64_t floor_idx = ticks_.floor(delta);  // last tick with price <= query
         const int t = lowestSetAbove(static_cast<int>(floor_idx));
         if (t < 0) {
             return nullptr;
@@ -319,7 +397,47 @@ class ArrayLevels {
         return levels_[static_cast<size_t>(t)];
     }
 
+    // Whether price is on the tick grid, at or above base_fp. Only such
+    // prices have a slot; OrderBook rejects the rest before they get here.
+    [[nodiscard]] bool onGrid(const Decimal& price) const {
+        uint64_t q;
+        return price.fp >= base_fp_ && ticks_.divides(price.fp - base_fp_, q);
+    }
+
     [[nodiscard]] uint64_t depth() const { return depth_; }
+    [[nodiscard]] uint64_t grows() const { return grows_.load(std::memory_order_relaxed); }
+    [[nodiscard]] size_t slabs() const { return queue_pool_.slabs(); }
+
+    // Prefetch hooks (see LevelStore). prefetchSlot pulls levels_[tick];
+    // prefetchQueue reads that slot and pulls the OrderQueue it points at.
+    // Prices off the grid or beyond capacity are ignored rather than asserted
+    // on, since a hint must never fault.
+    void prefetchSlot(const Decimal& price) const {
+        size_t t;
+        if (slotOf(price, t)) {
+            __builtin_prefetch(&levels_[t]);
+        }
+    }
+
+    void prefetchQueue(const Decimal& price) const {
+        size_t t;
+        if (slotOf(price, t) && levels_[t] != nullptr) {
+            __builtin_prefetch(levels_[t]);
+        }
+    }
+
+   private:
+    // Non-asserting tickIndex for find and hints: false when price is off the
+    // grid (see onGrid) or has no slot yet.
+    [[nodiscard]] bool slotOf(const Decimal& price, size_t& t) const {
+        const uint64_t fp = price.fp;
+        uint64_t q;
+        if (fp < base_fp_ || !ticks_.divides(fp - base_fp_, q)) {
+            return false;
+        }
+        t = static_cast<size_t>(q);
+        return t < levels_.size();
+    }
 };
 
 }  // namespace orderbook
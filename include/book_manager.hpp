@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "orderbook.hpp"
+#include "spsc_ring.hpp"
+#include "wait_strategy.hpp"
+
+namespace orderbook {
+
+using SymbolID = uint32_t;
+
+struct SymbolCommand {
+    SymbolID symbol{};
+    Command cmd{};
+};
+
+// One report leaving a book. New / cancel / replace are all OrderReports and
+// are told apart by msg_type (CreateOrder / CancelOrder / ModifyOrder).
+struct SymbolReport {
+    SymbolID symbol{};
+    std::variant<OrderReport, RejectReport, TradeReport> report;
+};
+
+// Notification that forwards a book's compact reports, tagged with its symbol,
+// to an outbound SpscRing. A full ring is back-pressure: the book's thread
+// waits (per WaitStrategy) until the consumer makes room, so no report is ever
+// dropped.
+class RingReportSink : public NotificationInterface<RingReportSink> {
+   public:
+    RingReportSink(SymbolID symbol, SpscRing<SymbolReport>& out, WaitStrategy wait) : symbol_(symbol), out_(&out), wait_(wait) {}
+
+    void onNew(const OrderReport& r) { put(r); }
+    void onCancel(const OrderReport& r) { put(r); }
+    void onReplace(const OrderReport& r) { put(r); }
+    void onReject(const RejectReport& r) { put(r); }
+    void onTrade(const TradeReport& r) { put(r); }
+    void onExecutionReport(const ExecutionReport&) {}  // every hook is overridden
+
+   private:
+    template <class Report>
+    void put(const Report& r) {
+        const SymbolReport report{symbol_, r};
+        while (!out_->tryPush(report)) {
+            idle(wait_);
+        }
+    }
+
+    SymbolID symbol_;
+    SpscRing<SymbolReport>* out_;
+    WaitStrategy wait_;
+};
+
+struct BookManagerConfig {
+    size_t workers = 1;
+    std::vector<int> cpus;  // cpus[i] pins worker i; missing or negative: not pinned
+    WaitStrategy wait = WaitStrategy::Pause;
+    size_t inbound_capacity = size_t{1} << 16;
+    size_t outbound_capacity = size_t{1} << 16;
+    // Symbol ids index a dense table, so they must lie in [0, max_symbol_id].
+    // Map sparse venue ids onto a compact range before they reach the manager.
+    SymbolID max_symbol_id = (SymbolID{1} << 20) - 1;
+
+    // Per-book sizing. Smaller than a standalone OrderBook's defaults because a
+    // manager holds many books; pools and the tick array grow on demand.
+    size_t price_level_pool_size = 256;
+    size_t order_pool_size = 1024;
+    size_t order_index_reserve = 1024;
+    uint64_t base_fp = 0;
+    uint64_t tick_fp = 100000000;
+    size_t num_ticks = 1024;
+};
+
+// Owns one OrderBook per symbol and shards them over worker threads.
+//
+// Symbols are assigned to workers round-robin as they are added. Each worker
+// owns its books outright and is fed by its own inbound SpscRing of
+// SymbolCommands and writes to its own outbound SpscRing of SymbolReports, so
+// workers share nothing and independent symbols scale with cores. All commands
+// of a symbol pass through one FIFO ring to one thread, so each symbol sees
+// exactly the reports it would see applied sequentially.
+//
+// Threading contract: addSymbol / book() only while stopped; submit() from a
+// single producer thread; pollReports(w) from a single consumer thread per
+// worker, which must keep polling until stop() returns (a full outbound ring
+// stalls that worker).
+template <template <PriceType> class Levels = ArrayLevels>
+class BookManager {
+   public:
+    using Book = OrderBook<RingReportSink, Levels>;
+
+    explicit BookManager(const BookManagerConfig& cfg = {}) : cfg_(cfg) {
+        if (cfg_.workers == 0) {
+            cfg_.workers = 1;
+        }
+        workers_.reserve(cfg_.workers);
+        for (size_t w = 0; w < cfg_.workers; ++w) {
+            workers_.push_back(std::make_unique<Worker>(cfg_.inbound_capacity, cfg_.outbound_capacity));
+        }
+    }
+
+    ~BookManager() { stop(); }
+
+    BookManager(const BookManager&) = delete;
+    BookManager& operator=(const BookManager&) = delete;
+
+    static constexpr uint32_t kNoWorker = UINT32_MAX;
+
+    // false if the symbol already exists, is above max_symbol_id or the workers
+    // are running.
+    bool addSymbol(SymbolID symbol) {
+        if (running_.load(std::memory_order_relaxed) || symbol > cfg_.max_symbol_id) {
+            return false;
+        }
+        if (symbol >= entries_.size()) {
+            entries_.resize(size_t{symbol} + 1);
+        }
+        if (entries_[symbol] != nullptr) {
+            return false;
+        }
+        const auto worker = static_cast<uint32_t>(symbols_++ % workers_.size());
+        entries_[symbol] = std::make_unique<Entry>(symbol, workers_[worker]->outbound, cfg_, worker);
+        return true;
+    }
+
+    [[nodiscard]] bool hasSymbol(SymbolID symbol) const { return symbol < entries_.size() && entries_[symbol] != nullptr; }
+    // The worker that owns the symbol, kNoWorker if unknown.
+    [[nodiscard]] uint32_t workerOf(SymbolID symbol) const { return hasSymbol(symbol) ? entries_[symbol]->worker : kNoWorker; }
+    [[nodiscard]] size_t workers() const { return workers_.size(); }
+
+    // The symbol's book, nullptr if unknown. Only while stopped.
+    Book* book(SymbolID symbol) { return hasSymbol(symbol) ? &entries_[symbol]->book : nullptr; }
+
+    void start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        for (uint32_t w = 0; w < workers_.size(); ++w) {
+            workers_[w]->thread = std::thread(&BookManager::run, this, w);
+        }
+    }
+
+    // Let every worker drain its inbound ring, then join them. Call after the
+    // last submit(), from the producer thread.
+    void stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        for (auto& w : workers_) {
+            w->thread.join();
+        }
+    }
+
+    // false if the symbol is unknown or its worker's inbound ring is full.
+    bool submit(const SymbolCommand& c) {
+        if (!hasSymbol(c.symbol)) [[unlikely]] {
+            return false;
+        }
+        return workers_[entries_[c.symbol]->worker]->inbound.tryPush(c);
+    }
+
+    bool submit(SymbolID symbol, const Command& cmd) { return submit(SymbolCommand{symbol, cmd}); }
+
+    // Hand up to max of worker w's pending reports to f, in the order the
+    // worker produced them. Returns how many were handed over.
+    template <class F>
+    size_t pollReports(uint32_t worker, F&& f, size_t max = 256) {
+        return workers_[worker]->outbound.consume(max, f);
+    }
+
+   private:
+    struct Entry {
+        RingReportSink sink;
+        Book book;
+        uint32_t worker;
+
+        Entry(SymbolID symbol, SpscRing<SymbolReport>& out, const BookManagerConfig& cfg, uint32_t worker)
+            : sink(symbol, out, cfg.wait),
+              book(sink, cfg.price_level_pool_size, cfg.order_pool_size, cfg.order_index_reserve, cfg.base_fp, cfg.tick_fp, cfg.num_ticks),
+              worker(worker) {}
+    };
+
+    struct Worker {
+        SpscRing<SymbolCommand> inbound;
+        SpscRing<SymbolReport> outbound;
+        std::thread thread;
+
+        Worker(size_t inbound_capacity, size_t outbound_capacity) : inbound(inbound_capacity), outbound(outbound_capacity) {}
+    };
+
+    void run(uint32_t w) {
+        constexpr size_t kBatch = 64;
+        if (w < cfg_.cpus.size()) {
+            pinCurrentThread(cfg_.cpus[w]);
+        }
+
+        auto& inbound = workers_[w]->inbound;
+        const auto apply = [this](const SymbolCommand& c) { entries_[c.symbol]->book.apply(c.cmd); };
+        for (;;) {
+            const bool stopping = !running_.load(std::memory_order_acquire);
+            if (inbound.consume(kBatch, apply) == 0) {
+                if (stopping) {
+                    return;
+                }
+                idle(cfg_.wait);
+            }
+        }
+    }
+
+    BookManagerConfig cfg_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::unique_ptr<Entry>> entries_;  // by symbol id
+    size_t symbols_ = 0;
+    std::atomic<bool> running_{false};
+};
+
+}  // namespace orderbook
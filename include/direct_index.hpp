@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "object_pool.hpp"
+#include "order.hpp"
+#include "order_index.hpp"
+#include "types.hpp"
+
+namespace orderbook {
+namespace index {
+
+// Direct-mapped OrderID -> Order* index for venues that assign dense,
+// increasing ids, selected through OrderBook's Index parameter like the other
+// policies. id >> kPageBits picks an entry in a page directory and the low bits
+// a slot in that page, so a lookup is two dependent loads with no hashing and
+// no chain.
+//
+// Pages of 512 pointers (4 KiB) are allocated when an id first lands in them.
+// A page whose live orders have all gone is recycled to a spare list for the
+// next new page, unless it is the newest page an id has landed in, which the
+// id frontier is still filling. The directory covers the pages from
+// the oldest live one to the newest, so a sliding window of ids keeps it
+// short. An id more than kMaxPages pages away from that window goes to a
+// small FibHashIndex instead, so stray ids stay correct without stretching
+// the directory; lookups only consult it while it holds something.
+class DirectIndex {
+   public:
+    static constexpr unsigned kPageBits = 9;
+    static constexpr size_t kPageSize = size_t(1) << kPageBits;
+    static constexpr size_t kMaxPages = size_t(1) << 20;
+
+    using OrderPool = pool::ObjectPool<Order>;
+
+    // reserve_entries sizes the directory for that many ids from the first
+    // one inserted.
+    explicit DirectIndex(size_t reserve_entries = 1u << 16) : dir_reserve_(pagesFor(reserve_entries)), overflow_(kOverflowReserve) {
+        dir_.reserve(dir_reserve_);
+    }
+
+    // Form OrderBook uses for every index policy; the pool is not needed.
+    DirectIndex(const OrderPool&, size_t reserve_entries) : DirectIndex(reserve_entries) {}
+
+    DirectIndex(const DirectIndex&) = delete;
+    DirectIndex& operator=(const DirectIndex&) = delete;
+
+    Order* find(uint64_t id) const {
+        if (const Page* pg = pageOf(id); pg != nullptr) {
+            if (Order* o = pg->slots[id & kSlotMask]; o != nullptr) return o;
+        }
+        return overflow_.size() != 0 ? overflow_.find(id) : nullptr;
+    }
+
+    bool contains(uint64_t id) const { return find(id) != nullptr; }
+
+    size_t size() const { return direct_size_ + overflow_.size(); }
+
+    // Cold-path counters. rehashes() counts directory reallocations (and the
+    // overflow index's rehashes); slabs() counts pages allocated, recycled ones
+    // once, plus the overflow index's node slabs.
+    uint64_t rehashes() const { return rehashes_.load(std::memory_order_relaxed) + overflow_.rehashes(); }
+    size_t slabs() const { return pages_allocated_.load(std::memory_order_relaxed) + overflow_.slabs(); }
+
+    // Size the directory for n ids from the start of the window. Never shrinks.
+    void reserve(size_t n) {
+        dir_reserve_ = std::max(dir_reserve_, pagesFor(n));
+        if (!dir_.empty()) growDirectory(dir_reserve_);
+    }
+
+    // Prefetch hooks with FibHashIndex's contract: prefetchBucket pulls id's
+    // directory entry, prefetchNode reads it and pulls id's slot.
+    void prefetchBucket(uint64_t id) const {
+        if (const size_t p = dirSlot(id); p < dir_.size()) __builtin_prefetch(&dir_[p]);
+    }
+
+    void prefetchNode(uint64_t id) const {
+        if (const Page* pg = pageOf(id); pg != nullptr) __builtin_prefetch(&pg->slots[id & kSlotMask]);
+    }
+
+    void insert(uint64_t id, Order* o) {
+        // Caller must dedup (contains()) first; insert never overwrites a live id.
+        assert(find(id) == nullptr && "DirectIndex::insert on existing id");
+        const size_t p = dirSlot(id);
+        Page* pg = p < dir_.size() ? dir_[p] : nullptr;
+        if (pg == nullptr) [[unlikely]] {
+            insertNewPage(id, o);
+            return;
+        }
+        pg->slots[id & kSlotMask] = o;
+        ++pg->live;
+        ++direct_size_;
+    }
+
+    // Remove id and return its Order* (nullptr if absent); retires the page
+    // when that was its last live order.
+    Order* erase(uint64_t id) {
+        const size_t p = dirSlot(id);
+        Page* pg = p < dir_.size() ? dir_[p] : nullptr;
+        if (pg == nullptr || pg->slots[id & kSlotMask] == nullptr) {
+            return overflow_.size() != 0 ? overflow_.erase(id) : nullptr;
+        }
+        Order* o = pg->slots[id & kSlotMask];
+        pg->slots[id & kSlotMask] = nullptr;
+        --direct_size_;
+        if (--pg->live == 0 && base_ + p != newest_) retire(p);
+        return o;
+    }
+
+   private:
+    static constexpr uint64_t kSlotMask = kPageSize - 1;
+    static constexpr size_t kOverflowReserve = 256;
+
+    struct Page {
+        std::array<Order*, kPageSize> slots{};
+        size_t live = 0;
+    };
+
+    static size_t pagesFor(size_t n) { return std::max<size_t>(1, (n + kPageSize - 1) / kPageSize); }
+
+    // Directory position of id's page; wraps to a huge value for pages below
+    // the window, so one compare bounds both ends.
+    size_t dirSlot(uint64_t id) const { return static_cast<size_t>((id >> kPageBits) - base_); }
+
+    const Page* pageOf(uint64_t id) const {
+        const size_t p = dirSlot(id);
+        return p < dir_.size() ? dir_[p] : nullptr;
+    }
+
+    // insert() for an id whose page is not in the directory yet: extend the
+    // directory (or use the overflow index) and take a page for it.
+    void insertNewPage(uint64_t id, Order* o) {
+        const uint64_t page = id >> kPageBits;
+        if (!cover(page)) {
+            overflow_.insert(id, o);
+            return;
+        }
+        Page*& pg = dir_[page - base_];
+        if (pg == nullptr) pg = newPage();
+        pg->slots[id & kSlotMask] = o;
+        ++pg->live;
+        ++direct_size_;
+        if (page > newest_) {
+            // The previous frontier page can be retired now if it emptied.
+            const size_t prev = static_cast<size_t>(newest_ - base_);
+            newest_ = page;
+            if (prev < dir_.size() && dir_[prev] != nullptr && dir_[prev]->live == 0) retire(prev);
+        }
+    }
+
+    // Make the directory cover page, if that keeps it within kMaxPages.
+    // Returns false if page belongs in the overflow index.
+    bool cover(uint64_t page) {
+        if (direct_size_ == 0 && (dir_.empty() || page < base_ || page - base_ >= kMaxPages)) {
+            // Nothing live in the pages: re-anchor the window at this id.
+            resetDirectory(page);
+            return true;
+        }
+        if (page >= base_) {
+            const uint64_t need = page - base_ + 1;
+            if (need > kMaxPages) return false;
+            if (need > dir_.size()) growDirectory(static_cast<size_t>(need));
+            return true;
+        }
+        if (base_ - page + dir_.size() > kMaxPages) return false;
+        // An id below the window: rebuild the directory with page first.
+        const size_t shift = static_cast<size_t>(base_ - page);
+        std::vector<Page*> dir;
+        dir.reserve(std::max(dir_.size() + shift, dir_reserve_));
+        dir.assign(shift, nullptr);
+        dir.insert(dir.end(), dir_.begin(), dir_.end());
+        dir_ = std::move(dir);
+        base_ = page;
+        countRehash();
+        return true;
+    }
+
+    void resetDirectory(uint64_t page) {
+        for (Page* pg : dir_) {
+            if (pg != nullptr) spare_.push_back(pg);
+        }
+        dir_.clear();
+        base_ = page;
+        newest_ = page;
+        growDirectory(dir_reserve_);
+    }
+
+    // Extend the directory to n entries; a reallocation counts as a rehash.
+    void growDirectory(size_t n) {
+        if (n <= dir_.size()) return;
+        if (n > dir_.capacity()) {
+            dir_.reserve(std::max(n, dir_.capacity() * 2));
+            countRehash();
+        }
+        dir_.resize(n, nullptr);
+    }
+
+    Page* newPage() {
+        if (!spare_.empty()) {
+            // Every slot of a retired page was erased, so it is already clear.
+            Page* pg = spare_.back();
+            spare_.pop_back();
+            return pg;
+        }
+        owned_.push_back(std::make_unique<Page>());
+        pages_allocated_.store(pages_allocated_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return owned_.back().get();
+    }
+
+    // Recycle the empty page at directory slot p and, if it was the oldest,
+    // drop the leading run of empty entries so the window starts at the
+    // oldest live page. The newest page is never retired, so the run ends
+    // there at the latest.
+    void retire(size_t p) {
+        spare_.push_back(dir_[p]);
+        dir_[p] = nullptr;
+        if (p != 0) return;
+        const size_t lead = static_cast<size_t>(std::find_if(dir_.begin(), dir_.end(), [](const Page* pg) { return pg != nullptr; }) - dir_.begin());
+        dir_.erase(dir_.begin(), dir_.begin() + lead);
+        base_ += lead;
+    }
+
+    void countRehash() { rehashes_.store(rehashes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    std::vector<Page*> dir_;
+    uint64_t base_ = 0;    // page number of dir_[0]
+    uint64_t newest_ = 0;  // highest page an id has landed in
+    size_t dir_reserve_;
+    size_t direct_size_ = 0;
+    std::vector<Page*> spare_;
+    std::vector<std::unique_ptr<Page>> owned_;
+    FibHashIndex overflow_;
+    std::atomic<uint64_t> rehashes_{0};
+    std::atomic<size_t> pages_allocated_{0};
+};
+
+}  // namespace index
+}  // namespace orderbook
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "book_manager.hpp"
+#include "orderbook.hpp"
+#include "spsc_ring.hpp"
+#include "wait_strategy.hpp"
+
+namespace orderbook {
+
+struct EngineRunnerConfig {
+    int cpu = -1;  // core to pin the engine thread to; negative: not pinned
+    WaitStrategy wait = WaitStrategy::Pause;
+    size_t inbound_capacity = size_t{1} << 16;
+    size_t outbound_capacity = size_t{1} << 16;
+    SymbolID symbol = 0;  // tag carried by every outbound SymbolReport
+};
+
+// Runs one book on a dedicated thread in a busy-poll loop.
+//
+// The runner owns the book, an inbound SpscRing<Command> and an outbound
+// SpscRing<SymbolReport> that the book reports into through a RingReportSink.
+// The loop copies up to kBatch commands off the inbound ring and hands them to
+// processBatch, so the prefetch pipeline runs across each burst; when the ring
+// is empty it idles per the WaitStrategy. Steady state takes no locks and does
+// not allocate, and makes no syscalls unless the strategy is Yield. The flag the
+// loop polls sits on its own cache line, away from anything the producer or
+// consumer write.
+//
+// Threading contract: submit() from one producer thread, pollReports() from one
+// consumer thread that keeps polling until stop() returns (a full outbound ring
+// stalls the engine), book() only while stopped.
+template <class Book = OrderBook<RingReportSink>>
+class EngineRunner {
+   public:
+    static constexpr size_t kBatch = 64;
+
+    // bookArgs are passed to the Book constructor after the notification.
+    template <class... BookArgs>
+    explicit EngineRunner(const EngineRunnerConfig& cfg = {}, BookArgs&&... bookArgs)
+        : cfg_(cfg),
+          inbound_(cfg.inbound_capacity),
+          outbound_(cfg.outbound_capacity),
+          sink_(cfg.symbol, outbound_, cfg.wait),
+          book_(sink_, std::forward<BookArgs>(bookArgs)...),
+          batch_(kBatch) {}
+
+    ~EngineRunner() { stop(); }
+
+    EngineRunner(const EngineRunner&) = delete;
+    EngineRunner& operator=(const EngineRunner&) = delete;
+
+    void start() {
+        if (running_.flag.exchange(true)) {
+            return;
+        }
+        thread_ = std::thread(&EngineRunner::run, this);
+    }
+
+    // Graceful shutdown: the engine applies everything already submitted, then
+    // exits. Call after the last submit(), from the producer thread.
+    void stop() {
+        if (!running_.flag.exchange(false)) {
+            return;
+        }
+        thread_.join();
+    }
+
+    [[nodiscard]] bool running() const { return running_.flag.load(std::memory_order_relaxed); }
+
+    // false when the inbound ring is full.
+    bool submit(const Command& cmd) { return inbound_.tryPush(cmd); }
+
+    template <class F>
+    size_t pollReports(F&& f, size_t max = 256) {
+        return outbound_.consume(max, f);
+    }
+
+    Book& book() { return book_; }
+
+   private:
+    void run() {
+        pinCurrentThread(cfg_.cpu);
+
+        Command* batch = batch_.data();
+        for (;;) {
+            const bool stopping = !running_.flag.load(std::memory_order_acquire);
+            size_t n = 0;
+            inbound_.consume(kBatch, [&](const Command& c) { batch[n++] = c; });
+            if (n != 0) {
+                book_.processBatch(std::span<const Command>(batch, n));
+            } else if (stopping) {
+                return;
+            } else {
+                idle(cfg_.wait);
+            }
+        }
+    }
+
+    struct alignas(kCacheLine) RunFlag {
+        std::atomic<bool> flag{false};
+    };
+
+    EngineRunnerConfig cfg_;
+    SpscRing<Command> inbound_;
+    SpscRing<SymbolReport> outbound_;
+    RingReportSink sink_;
+    Book book_;
+    std::vector<Command> batch_;
+    RunFlag running_;
+    std::thread thread_;
+};
+
+}  // namespace orderbook
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "spsc_ring.hpp"
+#include "types.hpp"
+
+namespace orderbook {
+namespace journal {
+
+// Write-ahead command journal.
+//
+// Every inbound Command is given the next sequence number and written as one
+// fixed-size Record to a preallocated file before it is applied to the book.
+// The hot thread only copies the record into an SpscRing; a writer thread owned
+// by the Journal drains the ring, writes records in batches and fdatasyncs them
+// in groups (group commit), so the hot thread never waits on the disk.
+// durableSeq() reports how far the file is known to be on stable storage.
+//
+// File layout: a 64-byte FileHeader, then Record slots. Record i holds seq i+1;
+// the journal ends at the first slot whose seq or checksum does not match, which
+// also discards a record torn by a crash. Integers are in host byte order.
+
+inline constexpr uint64_t kMagic = 0x314C4E524A424FULL;  // "OBJRNL1"
+inline constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+    uint64_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t record_size = 0;
+    uint64_t capacity = 0;  // record slots preallocated after the header
+    uint8_t reserved[40] = {};
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct Record {
+    uint64_t seq;
+    uint64_t id;
+    uint64_t qty;    // Decimal fixed-point value
+    uint64_t price;  // Decimal fixed-point value
+    uint8_t kind;
+    uint8_t type;
+    uint8_t side;
+    uint8_t flag;
+    uint32_t check;  // checksum of every byte above
+};
+static_assert(sizeof(Record) == 40);
+
+Record encode(uint64_t seq, const Command& cmd);
+Command decode(const Record& r);
+[[nodiscard]] uint32_t checksum(const Record& r);
+
+struct JournalConfig {
+    size_t capacity_records = size_t{1} << 20;  // file is preallocated for this many
+    size_t ring_capacity = size_t{1} << 16;     // hot thread -> writer thread
+    size_t sync_every_records = 1024;           // fdatasync after this many records...
+    std::chrono::microseconds sync_interval{200};  // ...or once the oldest unsynced one is this old
+    std::chrono::microseconds max_idle_sleep{50};  // longest poll interval of an idle writer
+};
+
+// Appending side. Opening an existing journal continues after its last valid
+// record, so a process can replay a journal and then keep writing to it; any
+// records left past that point by a crash are cleared first.
+class Journal {
+   public:
+    explicit Journal(const std::string& path, const JournalConfig& cfg = {});
+    ~Journal();  // close()
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // false when the file could not be opened, validated or preallocated.
+    [[nodiscard]] bool ok() const { return fd_ >= 0; }
+
+    // Hot path: assign cmd the next seq and hand it to the writer thread.
+    // Returns false, recording nothing, when the ring is full (the writer has
+    // fallen behind) or the file is full; the caller decides whether to retry
+    // or refuse the command.
+    bool tryAppend(const Command& cmd);
+
+    [[nodiscard]] uint64_t lastSeq() const { return next_seq_ - 1; }
+    [[nodiscard]] uint64_t durableSeq() const { return durable_seq_.load(std::memory_order_acquire); }
+
+    // Drain the ring, sync and stop the writer thread. Idempotent.
+    void close();
+
+   private:
+    void run();
+
+    JournalConfig cfg_;
+    int fd_ = -1;
+    uint64_t next_seq_ = 1;
+    SpscRing<Record> ring_;
+    alignas(kCacheLine) std::atomic<uint64_t> durable_seq_{0};
+    std::atomic<bool> running_{false};
+    std::thread writer_;
+};
+
+// Reading side: maps the file read-only and exposes its valid records.
+class JournalReader {
+   public:
+    explicit JournalReader(const std::string& path);
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    [[nodiscard]] bool ok() const { return base_ != nullptr; }
+    [[nodiscard]] std::span<const Record> records() const { return records_; }
+
+    // Feed every record with seq > after_seq back through book.apply, in order.
+    // Returns the seq of the last record applied (after_seq if none).
+    template <class Book>
+    uint64_t replay(Book& book, uint64_t after_seq = 0) const {
+        for (size_t i = after_seq; i < records_.size(); ++i) {
+            book.apply(decode(records_[i]));
+        }
+        return after_seq < records_.size() ? records_.size() : after_seq;
+    }
+
+   private:
+    void* base_ = nullptr;
+    size_t mapped_ = 0;
+    std::span<const Record> records_;
+};
+
+// Number of valid records in slots, i.e. the length of the prefix whose seqs
+// run 1, 2, 3, ... with good checksums.
+size_t validPrefix(std::span<const Record> slots);
+
+// Front end for a book: journals each command, then applies it. A command the
+// journal cannot take is refused (false) before it reaches the book, so the
+// book never runs ahead of the journal.
+template <class Book>
+class JournaledBook {
+   public:
+    JournaledBook(Journal& journal, Book& book) : journal_(journal), book_(book) {}
+
+    bool apply(const Command& cmd) {
+        if (!journal_.tryAppend(cmd)) [[unlikely]] {
+            return false;
+        }
+        book_.apply(cmd);
+        return true;
+    }
+
+    bool addOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) {
+        return apply({.kind = CommandType::Add, .type = type, .side = side, .flag = flag, .id = id, .qty = qty, .price = price});
+    }
+
+    bool cancelOrder(OrderID id) { return apply({.kind = CommandType::Cancel, .id = id}); }
+
+    bool modifyOrder(OrderID id, Decimal qty, Decimal price) { return apply({.kind = CommandType::Modify, .id = id, .qty = qty, .price = price}); }
+
+   private:
+    Journal& journal_;
+    Book& book_;
+};
+
+}  // namespace journal
+}  // namespace orderbook
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "types.hpp"
+
+namespace orderbook {
+
+// Incremental L2 (price-level) market data.
+//
+// After every inbound command OrderBook publishes one LevelUpdate per price
+// level the command changed (appended to, reduced, filled against or emptied),
+// carrying the level's state after the command. Updates of one command arrive
+// together in a single onLevelUpdates call. seq is a book-wide counter that
+// increases by exactly one per update, so a subscriber detects a gap when an
+// update's seq is not its predecessor's + 1.
+struct LevelUpdate {
+    uint64_t seq = 0;
+    Decimal price{};
+    Decimal qty{};        // total resting qty at price; zero when the level is gone
+    uint64_t orders = 0;  // resting orders at price; zero when the level is gone
+    Side side{};
+};
+
+// Incremental L3 (market-by-order) market data.
+//
+// One OrderEvent per change to a resting order, in the order they happened:
+//
+//   Add      order started resting;            qty = leaves_qty = resting qty
+//   Reduce   resting qty amended down in place; qty = amount removed
+//   Delete   order left the book unfilled;      qty = amount removed, leaves_qty = 0
+//   Execute  order traded as maker;             qty = traded qty
+//
+// leaves_qty is always the order's resting qty after the event, so an Execute
+// with leaves_qty 0 also means the order is gone (no separate Delete follows).
+// position is the order's 0-based place in its level's FIFO: the back of the
+// queue for Add, the front for Execute. An amend that loses time priority is a
+// Delete followed by an Add. seq is a book-wide counter of its own, separate
+// from the L2 seq, increasing by exactly one per event.
+enum class OrderEventType : uint8_t {
+    Add,
+    Reduce,
+    Delete,
+    Execute,
+};
+
+struct OrderEvent {
+    uint64_t seq = 0;
+    OrderID order_id = 0;
+    Decimal price{};
+    Decimal qty{};
+    Decimal leaves_qty{};
+    uint64_t position = 0;
+    Side side{};
+    OrderEventType type{};
+};
+
+// MarketData policy (compile-time, no virtual dispatch). OrderBook owns one
+// instance, reachable through OrderBook::marketData(). A policy that provides
+//
+//   void onLevelUpdates(std::span<const LevelUpdate> updates);
+//
+// receives the L2 stream, and one that provides
+//
+//   void onOrderEvents(std::span<const OrderEvent> events);
+//
+// receives the L3 stream; a policy may provide either or both. Both are
+// delivered once per command, L2 first. Whatever a policy does not provide
+// (NoMarketData provides neither) has its tracking hooks compiled away.
+template <class MarketData>
+concept LevelListener = requires(MarketData& md, std::span<const LevelUpdate> updates) { md.onLevelUpdates(updates); };
+
+template <class MarketData>
+concept OrderListener = requires(MarketData& md, std::span<const OrderEvent> events) { md.onOrderEvents(events); };
+
+struct NoMarketData {};
+
+// Collects the levels one command touched and, at the end of the command, turns
+// them into LevelUpdates. Within a command every touch of a level is
+// consecutive (a sweep walks away from a level once it is done with it, and a
+// re-priced order's old and new levels differ), so comparing against the last
+// touch is enough to keep one update per level. Both buffers are reserved up
+// front and only grow past that on an unusually deep sweep.
+class LevelDeltaTracker {
+    struct Touch {
+        Decimal price;
+        Side side;
+    };
+
+    std::vector<Touch> touched_;
+    std::vector<LevelUpdate> updates_;
+    uint64_t seq_ = 0;
+
+   public:
+    explicit LevelDeltaTracker(size_t reserve = 64) {
+        touched_.reserve(reserve);
+        updates_.reserve(reserve);
+    }
+
+    void touch(Side side, const Decimal& price) {
+        if (!touched_.empty() && touched_.back().side == side && touched_.back().price == price) {
+            return;
+        }
+        touched_.push_back({price, side});
+    }
+
+    [[nodiscard]] bool empty() const { return touched_.empty(); }
+
+    // levelInfo(side, price) -> LevelInfo reads a level's current state.
+    template <class LevelQuery>
+    std::span<const LevelUpdate> collect(LevelQuery&& levelInfo) {
+        updates_.clear();
+        for (const auto& t : touched_) {
+            const LevelInfo info = levelInfo(t.side, t.price);
+            updates_.push_back({++seq_, t.price, info.qty, info.orders, t.side});
+        }
+        touched_.clear();
+        return updates_;
+    }
+};
+
+struct NoLevelTracking {};
+
+// Buffers the OrderEvents of one command and numbers them. Reserved up front
+// like LevelDeltaTracker; seq is assigned on push.
+class OrderEventBuffer {
+    std::vector<OrderEvent> events_;
+    uint64_t seq_ = 0;
+
+   public:
+    explicit OrderEventBuffer(size_t reserve = 64) { events_.reserve(reserve); }
+
+    void push(OrderEvent event) {
+        event.seq = ++seq_;
+        events_.push_back(event);
+    }
+
+    [[nodiscard]] bool empty() const { return events_.empty(); }
+    [[nodiscard]] std::span<const OrderEvent> events() const { return events_; }
+    void clear() { events_.clear(); }
+};
+
+struct NoOrderEvents {};
+
+}  // namespace orderbook
@@ -1,41 +1,161 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <new>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace pool {
 
+// Stable 32-bit name of a pool slot; see ObjectPool::get / handle.
+using Handle = uint32_t;
+inline constexpr Handle kNullHandle = UINT32_MAX;
+
+// How an ObjectPool backs its slabs, chosen per pool. The default is plain
+// operator new. Any other setting maps each slab with mmap:
+//
+//   pages      Transparent: a 2 MiB-aligned mapping with MADV_HUGEPAGE, so
+//              the kernel can back it with transparent huge pages. Huge:
+//              MAP_HUGETLB from the reserved hugetlbfs pool; falls back to
+//              Transparent when no huge pages are free.
+//   prefault   fault every page in when the slab is allocated instead of on
+//              first use on the hot path.
+//   lock       mlock the slab so it is never paged out.
+//   numa_node  bind the slab's pages to that node (mbind); -1 leaves
+//              placement to the kernel.
+//
+// lock and numa_node are best effort: a failure (RLIMIT_MEMLOCK, no such
+// node) leaves the slab usable, just unlocked or unbound.
+//
+// grower moves growth off the owning thread (see SlabGrower): once free slots
+// fall to low_watermark (0 picks a quarter of the pool's capacity), the pool
+// asks grower for its next slab and adopts it when ready.
+class SlabGrower;
+
+struct SlabPolicy {
+    enum class Pages : uint8_t {
+        Default,
+        Transparent,
+        Huge,
+    };
+
+    Pages pages = Pages::Default;
+    bool prefault = false;
+    bool lock = false;
+    int numa_node = -1;
+    SlabGrower* grower = nullptr;
+    size_t low_watermark = 0;
+
+    [[nodiscard]] bool mapped() const { return pages != Pages::Default || prefault || lock || numa_node >= 0; }
+};
+
+namespace detail {
+// Slab memory as policy asks for it (object_pool.cpp): operator new with
+// align unless policy.mapped(), else an mmap, which is page aligned.
+// allocateSlab throws std::bad_alloc on failure.
+void* allocateSlab(size_t bytes, size_t align, const SlabPolicy& policy);
+void freeSlab(void* slab, size_t bytes, size_t align, const SlabPolicy& policy);
+}  // namespace detail
+
+// One pool's request to a SlabGrower. The pool fills in the sizes and posts
+// it; the grower allocates the slab, links its count slots of slot_size bytes
+// into a free list in address order (which also faults every page in on the
+// grower's thread) and publishes it by setting ready. slab stays null if the
+// allocation failed.
+struct SlabRequest {
+    size_t count = 0;
+    size_t slot_size = 0;
+    size_t align = 0;
+    SlabPolicy policy{};
+    void* slab = nullptr;
+    SlabRequest* next = nullptr;
+    std::atomic<bool> pending{false};
+    std::atomic<bool> ready{false};
+};
+
+// Helper thread that allocates slabs for any number of pools whose
+// SlabPolicy names it. Pools hand requests over through a lock-free stack
+// and the grower hands each slab back through the request's ready flag, so
+// the owning thread never takes a lock. It wakes the grower with one futex
+// notify per slab. The grower must outlive every pool that uses it.
+class SlabGrower {
+   public:
+    SlabGrower();
+    ~SlabGrower();
+
+    SlabGrower(const SlabGrower&) = delete;
+    SlabGrower& operator=(const SlabGrower&) = delete;
+
+    void post(SlabRequest* request);
+
+   private:
+    void run();
+
+    std::atomic<SlabRequest*> requests_{nullptr};
+    SlabRequest stop_;
+    std::thread thread_;
+};
+
 // O(1)-acquire / O(1)-release slab allocator with an intrusive LIFO free list.
 // Slabs double on growth and live objects are never relocated. Not thread-safe.
 // Callers must release everything they acquire; the dtor frees slab memory but
-// does not run destructors on outstanding objects.
+// does not run destructors on outstanding objects. With a SlabGrower in the
+// policy, new slabs are allocated on the grower's thread ahead of need. trim()
+// gives slabs with no live objects back; growth reallocates them first.
+//
+// Every slot also has a 32-bit handle, its index across all slabs in
+// allocation order, so containers can link pooled objects with 4-byte indices
+// instead of 8-byte pointers. The first slab is rounded up to a power of two,
+// which makes every slab boundary a power of two too: get() turns a handle
+// into a pointer with a shift, a bit scan and one load.
 template <typename T>
 class ObjectPool {
    public:
-    explicit ObjectPool(size_t fixed_size) {
-        next_slab_size_ = fixed_size ? fixed_size : 1;
-        allocate_slab(next_slab_size_);
+    using Handle = pool::Handle;
+    static constexpr Handle kNullHandle = pool::kNullHandle;
+
+    explicit ObjectPool(size_t fixed_size, const SlabPolicy& policy = {}) : policy_(policy) {
+        first_slab_log2_ = static_cast<unsigned>(std::countr_zero(std::bit_ceil(fixed_size ? fixed_size : 1)));
+        // Room for every slab up front, so adopting one never allocates.
+        slabs_.reserve(bias_.size());
+        allocate_slab(0);
     }
 
     ObjectPool(const ObjectPool&) = delete;
     ObjectPool& operator=(const ObjectPool&) = delete;
 
     ~ObjectPool() {
-        for (Slot* slab : slabs_) {
-            ::operator delete[](static_cast<void*>(slab), std::align_val_t{alignof(T)});
+        // A slab still being built belongs to this pool too.
+        if (request_.pending.load(std::memory_order_relaxed)) {
+            while (!request_.ready.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            if (request_.slab != nullptr) {
+                detail::freeSlab(request_.slab, request_.count * sizeof(Slot), alignof(T), policy_);
+            }
+        }
+        for (size_t k = 0; k < slabs_.size(); ++k) {
+            if (slabs_[k] != nullptr) {
+                detail::freeSlab(slabs_[k], slabSize(k) * sizeof(Slot), alignof(T), policy_);
+            }
         }
     }
 
     template <typename... Args>
     T* acquire(Args&&... args) {
-        if (free_head_ == nullptr) {
-            allocate_slab(next_slab_size_);
+        if (free_count_ <= low_watermark_) [[unlikely]] {
+            refill();
         }
         Slot* slot = free_head_;
         free_head_ = slot->next;
+        --free_count_;
         return new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
     }
 
@@ -44,9 +164,95 @@ class ObjectPool {
         Slot* slot = reinterpret_cast<Slot*>(obj);
         slot->next = free_head_;
         free_head_ = slot;
+        ++free_count_;
         return true;
     }
 
+    // Slabs allocated so far (the initial one included). Only the owning thread
+    // allocates; any thread may read this.
+    [[nodiscard]] size_t slabs() const { return slab_count_.load(std::memory_order_relaxed); }
+
+    // Times acquire() found the free list empty after construction and had to
+    // allocate a slab itself, or wait for its grower to finish one.
+    [[nodiscard]] size_t stalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+    // Whether a slab asked of the grower is still being allocated. Owning
+    // thread only.
+    [[nodiscard]] bool growing() const { return request_.pending.load(std::memory_order_relaxed) && !request_.ready.load(std::memory_order_acquire); }
+
+    [[nodiscard]] const SlabPolicy& policy() const { return policy_; }
+
+    // Slots in slabs currently held, free or not.
+    [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    // Live objects per slab, indexed like the slabs; 0 for a slab trim()
+    // released. Counted by walking the free list, so O(free slots).
+    [[nodiscard]] std::vector<size_t> occupancy() const {
+        std::vector<size_t> live(slabs_.size());
+        for (size_t k = 0; k < slabs_.size(); ++k) {
+            live[k] = slabs_[k] != nullptr ? slabSize(k) - parked_count_[k] : 0;
+        }
+        for (const Slot* s = free_head_; s != nullptr; s = s->next) {
+            --live[slabOf(s)];
+        }
+        return live;
+    }
+
+    // Release slabs that hold no live object back to the OS while at least
+    // keep_free free slots remain. Returns the bytes released by this call.
+    //
+    // A trim pass walks the free list once, parking each free slot on a list
+    // of its slab's; a slab whose every slot is parked is released on the
+    // spot. One call moves at most max_slots slots, so a pass can be spread
+    // over calls at quiet moments on the owning thread, each O(max_slots),
+    // until trimming() is false. Reaching the end of the free list ends the
+    // pass and hands the slots still parked back in O(slabs); so does an
+    // acquire() that needs them, which never waits or grows the pool for a
+    // pass in progress. With a grower, the low watermark's worth of slots at
+    // the head of the free list is left alone. Handles are unaffected: a
+    // released slab keeps its handle range, and is the first to be allocated
+    // again when the pool next grows.
+    size_t trim(size_t keep_free = 0, size_t max_slots = SIZE_MAX) {
+        trimming_ = true;
+        size_t bytes = 0;
+        for (; max_slots != 0 && free_count_ > trimFloor(); --max_slots) {
+            Slot* s = free_head_;
+            free_head_ = s->next;
+            --free_count_;
+            const size_t k = slabOf(s);
+            if (parked_head_[k] == nullptr) {
+                parked_tail_[k] = s;
+            }
+            s->next = parked_head_[k];
+            parked_head_[k] = s;
+            ++parked_;
+            if (++parked_count_[k] == slabSize(k) && free_count_ + parked_ >= keep_free + slabSize(k)) {
+                bytes += releaseSlab(k);
+            }
+        }
+        if (free_count_ <= trimFloor()) {
+            unpark();
+        }
+        return bytes;
+    }
+
+    // Whether a trim pass has more of the free list to walk.
+    [[nodiscard]] bool trimming() const { return trimming_; }
+
+    // Object for a handle from handle(). Slab k holds handles
+    // [first * (2^k - 1), first * (2^(k+1) - 1)).
+    [[nodiscard]] T* get(Handle h) const {
+        const size_t k = static_cast<size_t>(std::bit_width((size_t{h} >> first_slab_log2_) + 1)) - 1;
+        return reinterpret_cast<T*>(bias_[k] + size_t{h} * sizeof(Slot));
+    }
+
+    // Handle of a live object; kNullHandle for a pointer outside the pool.
+    [[nodiscard]] Handle handle(const T* obj) const {
+        const auto* slot = reinterpret_cast<const Slot*>(obj);
+        const size_t k = slabOf(slot);
+        return k == kNoSlab ? kNullHandle : static_cast<Handle>(firstHandle(k) + static_cast<size_t>(slot - slabs_[k]));
+    }
+
    private:
     // A free slot stores its free-list link in its own storage, so there is no
     // per-object overhead.
@@ -55,22 +261,205 @@ class ObjectPool {
         std::aligned_storage_t<sizeof(T), alignof(T)> storage;
     };
 
-    void allocate_slab(size_t count) {
-        // Reserve the slot first so push_back can't throw after the raw alloc.
-        slabs_.reserve(slabs_.size() + 1);
-        Slot* slab = static_cast<Slot*>(
-            ::operator new[](count * sizeof(Slot), std::align_val_t{alignof(T)}));
-        slabs_.push_back(slab);
+    static constexpr size_t kNoSlab = SIZE_MAX;
+
+    // Slab k holds slabSize(k) slots with handles from firstHandle(k).
+    size_t slabSize(size_t k) const { return size_t{1} << (first_slab_log2_ + k); }
+    size_t firstHandle(size_t k) const { return slabSize(k) - slabSize(0); }
+
+    // Index of the held slab containing slot, or kNoSlab. Searches slabs
+    // newest first; the newest slab holds at least half of all slots, so this
+    // is one or two range checks on average.
+    size_t slabOf(const Slot* slot) const {
+        for (size_t k = slabs_.size(); k-- > 0;) {
+            if (slabs_[k] != nullptr && std::greater_equal<const Slot*>()(slot, slabs_[k]) && std::less<const Slot*>()(slot, slabs_[k] + slabSize(k))) {
+                return k;
+            }
+        }
+        return kNoSlab;
+    }
+
+    // Slab growth fills next: the smallest one trim() released, so regrowth
+    // repeats the original doubling, else a new one after the last.
+    size_t nextSlab() const {
+        if (released_ != 0) {
+            for (size_t k = 0; k < slabs_.size(); ++k) {
+                if (slabs_[k] == nullptr) {
+                    return k;
+                }
+            }
+        }
+        return slabs_.size();
+    }
+
+    // Handles of a new slab k must stay below kNullHandle.
+    bool fits(size_t k) const { return k < slabs_.size() || firstHandle(k) + slabSize(k) < kNullHandle; }
+
+    void allocate_slab(size_t k) {
+        if (!fits(k)) {
+            throw std::bad_alloc();
+        }
+        const size_t count = slabSize(k);
+        Slot* slab = static_cast<Slot*>(detail::allocateSlab(count * sizeof(Slot), alignof(T), policy_));
         for (size_t i = 0; i < count; ++i) {
             slab[i].next = free_head_;
             free_head_ = &slab[i];
         }
-        next_slab_size_ = count * 2;
+        addSlab(k, slab);
+    }
+
+    // Account for slab k, whose slots are already on the free list.
+    void addSlab(size_t k, Slot* slab) {
+        if (k == slabs_.size()) {
+            slabs_.push_back(slab);
+        } else {
+            slabs_[k] = slab;
+            --released_;
+        }
+        bias_[k] = reinterpret_cast<uintptr_t>(slab) - firstHandle(k) * sizeof(Slot);
+        capacity_ += slabSize(k);
+        free_count_ += slabSize(k);
+        updateWatermark();
+        slab_count_.store(slab_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Free slots a trim pass leaves on the free list: none, or with a grower
+    // enough that parking never drops acquire() to its low watermark.
+    size_t trimFloor() const { return policy_.grower != nullptr ? low_watermark_ + 1 : 0; }
+
+    // Give back slab k, all of whose slots are parked.
+    size_t releaseSlab(size_t k) {
+        detail::freeSlab(slabs_[k], slabSize(k) * sizeof(Slot), alignof(T), policy_);
+        slabs_[k] = nullptr;
+        ++released_;
+        capacity_ -= slabSize(k);
+        parked_ -= slabSize(k);
+        parked_head_[k] = nullptr;
+        parked_count_[k] = 0;
+        updateWatermark();
+        return slabSize(k) * sizeof(Slot);
+    }
+
+    // End the trim pass: splice every parked list back onto the free list.
+    void unpark() {
+        for (size_t k = 0; k < slabs_.size() && parked_ != 0; ++k) {
+            if (parked_head_[k] != nullptr) {
+                parked_tail_[k]->next = free_head_;
+                free_head_ = parked_head_[k];
+                free_count_ += parked_count_[k];
+                parked_ -= parked_count_[k];
+                parked_head_[k] = nullptr;
+                parked_count_[k] = 0;
+            }
+        }
+        trimming_ = false;
+    }
+
+    void updateWatermark() {
+        low_watermark_ = policy_.grower == nullptr ? 0 : policy_.low_watermark != 0 ? policy_.low_watermark : capacity_ / 4;
+    }
+
+    // acquire() at or below the low watermark. Without a grower that means the
+    // free list is empty and the next slab is allocated here. With one, the
+    // next slab is requested, or adopted once ready; only if the free list runs
+    // dry first does the owning thread wait for it. A trim pass in progress
+    // hands its parked slots back before any of that.
+    [[gnu::noinline]] void refill() {
+        if (trimming_) {
+            unpark();
+            if (free_count_ > low_watermark_) {
+                return;
+            }
+        }
+        if (policy_.grower == nullptr) {
+            stalls_.store(stalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            allocate_slab(nextSlab());
+            return;
+        }
+        if (!request_.pending.load(std::memory_order_relaxed)) {
+            if (const size_t k = nextSlab(); fits(k)) {
+                requested_slab_ = k;
+                request_.count = slabSize(k);
+                request_.slot_size = sizeof(Slot);
+                request_.align = alignof(T);
+                request_.policy = policy_;
+                request_.slab = nullptr;
+                request_.ready.store(false, std::memory_order_relaxed);
+                request_.pending.store(true, std::memory_order_relaxed);
+                policy_.grower->post(&request_);
+            }
+        } else if (request_.ready.load(std::memory_order_acquire)) {
+            adopt();
+            return;
+        }
+        if (free_head_ != nullptr) {
+            return;
+        }
+        stalls_.store(stalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (!request_.pending.load(std::memory_order_relaxed)) {
+            allocate_slab(nextSlab());  // throws: the pool is at its handle limit
+            return;
+        }
+        // Spin briefly, then give the CPU up in case the grower shares it.
+        for (unsigned spins = 0; !request_.ready.load(std::memory_order_acquire); ++spins) {
+            if (spins < kSpinsBeforeYield) {
+                cpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        adopt();
+    }
+
+    // Splice the grower's slab, already linked in address order, onto the
+    // free list. A failed background allocation is retried here.
+    void adopt() {
+        request_.pending.store(false, std::memory_order_relaxed);
+        auto* slab = static_cast<Slot*>(request_.slab);
+        if (slab == nullptr) {
+            if (free_head_ == nullptr) {
+                allocate_slab(nextSlab());
+            }
+            return;
+        }
+        slab[request_.count - 1].next = free_head_;
+        free_head_ = slab;
+        addSlab(requested_slab_, slab);
+    }
+
+    static constexpr unsigned kSpinsBeforeYield = 1024;
+
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#endif
     }
 
+    SlabPolicy policy_;
     Slot* free_head_ = nullptr;
-    size_t next_slab_size_ = 0;
+    size_t free_count_ = 0;
+    size_t low_watermark_ = 0;
+    size_t capacity_ = 0;
+    unsigned first_slab_log2_ = 0;
+    // Released slabs are null here until growth reallocates them.
     std::vector<Slot*> slabs_;
+    size_t released_ = 0;
+    // Free slots a trim pass has taken off the free list, per slab.
+    std::array<Slot*, 32> parked_head_{};
+    std::array<Slot*, 32> parked_tail_{};
+    std::array<size_t, 32> parked_count_{};
+    size_t parked_ = 0;
+    bool trimming_ = false;
+    // Per slab, its address minus its first handle's offset: get() is one load
+    // from here plus h * sizeof(Slot). Slab sizes double, so 32 slabs cover
+    // every handle.
+    std::array<uintptr_t, 32> bias_{};
+    std::atomic<size_t> slab_count_{0};
+    std::atomic<size_t> stalls_{0};
+    SlabRequest request_;
+    size_t requested_slab_ = 0;
 };
 
 }  // namespace pool
@@ -12,23 +12,34 @@ class OrderQueue;
 
 using namespace boost::intrusive;
 
-struct Order : public list_base_hook<constant_time_size<true>> {
+// One order per cache line. Matching walks a level's FIFO reading only the
+// list hook, id and qty, which sit together in the first 32 bytes; the fields
+// behind them are touched when an order is added, amended or leaves the book.
+// Line alignment also keeps an order from straddling two lines, so ObjectPool
+// slots (aligned to alignof(Order)) each cost exactly one line.
+struct alignas(64) Order : public list_base_hook<constant_time_size<true>> {
+    // hot: read and written per fill
     OrderID id;
     Decimal qty;
-    Decimal original_qty;
+
+    // cold
+    OrderQueue *queue = nullptr;
     Decimal price;
+    Decimal original_qty;
     Type type;
     Flag flag;
     Side side;
+    // Generation of the OrderHandle issued for this order; 0 if none was.
+    uint32_t generation = 0;
 
-    OrderQueue *queue = nullptr;
-
-    Order(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) : id(id), qty(qty), original_qty(qty), price(price), type(type), flag(flag), side(side){};
+    Order(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) : id(id), qty(qty), price(price), original_qty(qty), type(type), flag(flag), side(side){};
 
     friend bool operator<(const Order &a, const Order &b) { return a.id < b.id; }
     friend bool operator>(const Order &a, const Order &b) { return a.id > b.id; }
     friend bool operator==(const Order &a, const Order &b) { return a.id == b.id; }
 };
 
+static_assert(sizeof(Order) == 64, "Order should fill exactly one cache line");
+
 }  // namespace orderbook
 
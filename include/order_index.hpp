@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <vector>
 
 #include "object_pool.hpp"
@@ -20,113 +23,348 @@ namespace index {
 // (key * 2^64/phi) >> (64 - log2buckets), so there is no modulo and the cost is
 // independent of id magnitude. Rehash (double + re-link) at load factor ~0.7,
 // which is rare given the up-front bucket reserve.
-class FibHashIndex {
+//
+// Compact selects the link representation. FibHashIndex links with pointers:
+// a 24-byte Node and an 8-byte bucket. CompactFibHashIndex links with 32-bit
+// pool handles (ObjectPool::get): bucket and next name a node in the node
+// pool and val names the Order in the book's order pool, so a Node is 16 bytes
+// and a bucket 4, roughly halving the index's memory per order at the cost of
+// a handle decode per hop. Every Order a compact index holds must come from the
+// pool it was built with.
+//
+// Incremental spreads growth over writes on both sides of it. From half-way
+// to the load factor, each insert and erase clears up to kPrepareStep entries
+// of the doubled bucket array, reserved up front, so the array is ready
+// before it is needed. The insert that crosses the load factor only swaps it
+// in and keeps the old one; each insert and erase then moves up to
+// kMigrateStep old buckets across, and find and erase search both arrays
+// until the old one is drained. Growth leaves ~0.7 * old capacity inserts
+// before the next one, so the migration and the next preparation always
+// finish first; find stays read-only. reserve() still rebuilds at once, as it
+// is meant for a quiet moment before a bulk load.
+template <bool Compact, bool Incremental = false>
+class BasicFibHashIndex {
    public:
     // 2^64 / golden ratio: spreads the high bits of the product across buckets.
     static constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
 
+    // Old buckets moved per insert or erase while an incremental rehash runs.
+    static constexpr size_t kMigrateStep = 8;
+
+    // Entries of the next bucket array cleared per insert or erase once the
+    // table is half-way to growing.
+    static constexpr size_t kPrepareStep = 64;
+
+    using OrderPool = pool::ObjectPool<Order>;
+
     // Default sizes buckets for a deep live book (~1<<16 entries at lf<=0.7).
-    explicit FibHashIndex(size_t reserve_nodes = 1u << 16) : node_pool_(reserve_nodes ? reserve_nodes : 1) {
-        // Size buckets so reserve_nodes entries sit at load factor <= ~0.7.
-        size_t want = reserve_nodes + reserve_nodes / 2 + 1;
-        size_t cap = 16;
-        while (cap < want) cap <<= 1;
-        setCapacity(cap);
-    }
+    explicit BasicFibHashIndex(size_t reserve_nodes = 1u << 16)
+        requires(!Compact)
+        : BasicFibHashIndex(nullptr, reserve_nodes) {}
 
-    FibHashIndex(const FibHashIndex&) = delete;
-    FibHashIndex& operator=(const FibHashIndex&) = delete;
+    // Form OrderBook uses for every index policy; only the compact index reads
+    // the pool.
+    BasicFibHashIndex(const OrderPool& orders, size_t reserve_nodes) : BasicFibHashIndex(&orders, reserve_nodes) {}
+
+    BasicFibHashIndex(const BasicFibHashIndex&) = delete;
+    BasicFibHashIndex& operator=(const BasicFibHashIndex&) = delete;
 
     Order* find(uint64_t id) const {
-        for (Node* n = buckets_[bucketOf(id)]; n != nullptr; n = n->next) {
-            if (n->key == id) return n->val;
+        if (Order* o = findIn(buckets_[bucketOf(id)], id); o != nullptr || !migrating()) {
+            return o;
         }
-        return nullptr;
+        return findIn(old_buckets_[oldBucketOf(id)], id);
     }
 
     bool contains(uint64_t id) const { return find(id) != nullptr; }
 
+    size_t size() const { return size_; }
+
+    // Cold-path counters, safe to read from any thread: bucket-array rehashes
+    // and node-pool slab allocations so far.
+    uint64_t rehashes() const { return rehashes_.load(std::memory_order_relaxed); }
+    size_t slabs() const { return node_pool_.slabs(); }
+
+    // Give node-pool slabs with no live node back (see ObjectPool::trim).
+    size_t trim(size_t keep_free = 0, size_t max_slots = SIZE_MAX) { return node_pool_.trim(keep_free, max_slots); }
+    bool trimming() const { return node_pool_.trimming(); }
+
+    // True while an incremental rehash still has old buckets to move.
+    bool migrating() const {
+        if constexpr (Incremental) {
+            return !old_buckets_.empty();
+        } else {
+            return false;
+        }
+    }
+
+    // True once the doubled bucket array is cleared and waiting for growth.
+    bool prepared() const { return !next_buckets_.empty() && next_buckets_.size() == cap_ << 1; }
+
+    // Grow the bucket array once so that n entries fit without a rehash, e.g.
+    // before a bulk load. Never shrinks.
+    void reserve(size_t n) {
+        size_t cap = cap_;
+        while ((cap * 7) / 10 < n) cap <<= 1;
+        if (cap != cap_) rehash(cap);
+    }
+
+    // Software-prefetch hooks for batched lookups. prefetchBucket pulls the
+    // bucket slot for id; prefetchNode, issued once that slot should be cached,
+    // reads it and pulls the head node. Neither dereferences a node, so both
+    // are safe for ids that are absent or about to be inserted/erased.
+    // During a migration both hooks prefetch from both arrays.
+    void prefetchBucket(uint64_t id) const {
+        __builtin_prefetch(&buckets_[bucketOf(id)]);
+        if (migrating()) __builtin_prefetch(&old_buckets_[oldBucketOf(id)]);
+    }
+
+    void prefetchNode(uint64_t id) const {
+        if (NodeRef r = buckets_[bucketOf(id)]; r != kNoNode) {
+            __builtin_prefetch(node(r));
+        }
+        if (migrating()) {
+            if (NodeRef r = old_buckets_[oldBucketOf(id)]; r != kNoNode) {
+                __builtin_prefetch(node(r));
+            }
+        }
+    }
+
     void insert(uint64_t id, Order* o) {
         // Caller must dedup (contains()) first; insert never overwrites a live id.
         assert(find(id) == nullptr && "FibHashIndex::insert on existing id");
-        if (size_ + 1 > grow_threshold_) rehash(cap_ << 1);
+        if constexpr (Incremental) {
+            if (migrating()) [[unlikely]] {
+                migrate(kMigrateStep);
+            } else if (size_ >= prepare_threshold_) [[unlikely]] {
+                prepare(kPrepareStep);
+            }
+            if (size_ + 1 > grow_threshold_) beginRehash(cap_ << 1);
+        } else {
+            if (size_ + 1 > grow_threshold_) rehash(cap_ << 1);
+        }
         size_t b = bucketOf(id);
         Node* n = node_pool_.acquire();
         n->key = id;
-        n->val = o;
+        n->val = ref(o);
         n->next = buckets_[b];
-        buckets_[b] = n;
+        buckets_[b] = ref(n);
         ++size_;
     }
 
     // Unlink the node for id, recycle it to the pool, and return its Order*
     // (nullptr if absent).
     Order* erase(uint64_t id) {
-        size_t b = bucketOf(id);
+        if constexpr (Incremental) {
+            if (migrating()) [[unlikely]] {
+                migrate(kMigrateStep);
+                if (migrating()) {
+                    if (Order* o = unlink(old_buckets_[oldBucketOf(id)], id); o != nullptr) return o;
+                }
+            } else if (size_ >= prepare_threshold_) [[unlikely]] {
+                prepare(kPrepareStep);
+            }
+        }
+        return unlink(buckets_[bucketOf(id)], id);
+    }
+
+   private:
+    struct Node;
+    using NodePool = pool::ObjectPool<Node>;
+    using NodeRef = std::conditional_t<Compact, pool::Handle, Node*>;
+    using OrderRef = std::conditional_t<Compact, pool::Handle, Order*>;
+
+    struct Node {
+        uint64_t key;
+        OrderRef val;
+        NodeRef next;
+    };
+
+    static constexpr NodeRef kNoNode = [] {
+        if constexpr (Compact) {
+            return pool::kNullHandle;
+        } else {
+            return static_cast<Node*>(nullptr);
+        }
+    }();
+
+    // Nodes are backed like the orders they point to.
+    BasicFibHashIndex(const OrderPool* orders, size_t reserve_nodes)
+        : order_pool_(orders), node_pool_(reserve_nodes ? reserve_nodes : 1, orders != nullptr ? orders->policy() : pool::SlabPolicy{}) {
+        // Size buckets so reserve_nodes entries sit at load factor <= ~0.7.
+        size_t want = reserve_nodes + reserve_nodes / 2 + 1;
+        size_t cap = 16;
+        while (cap < want) cap <<= 1;
+        setCapacity(cap);
+    }
+
+    size_t bucketOf(uint64_t id) const { return static_cast<size_t>((id * GOLDEN) >> shift_); }
+    size_t oldBucketOf(uint64_t id) const { return static_cast<size_t>((id * GOLDEN) >> old_shift_); }
+
+    Order* findIn(NodeRef head, uint64_t id) const {
+        for (NodeRef r = head; r != kNoNode;) {
+            const Node* n = node(r);
+            if (n->key == id) return order(n->val);
+            r = n->next;
+        }
+        return nullptr;
+    }
+
+    // Unlink id's node from the chain at head, recycle it to the pool, and
+    // return its Order* (nullptr if absent).
+    Order* unlink(NodeRef& head, uint64_t id) {
         Node* prev = nullptr;
-        for (Node* n = buckets_[b]; n != nullptr; prev = n, n = n->next) {
+        for (NodeRef r = head; r != kNoNode;) {
+            Node* n = node(r);
             if (n->key == id) {
                 if (prev == nullptr) {
-                    buckets_[b] = n->next;
+                    head = n->next;
                 } else {
                     prev->next = n->next;
                 }
-                Order* v = n->val;
+                Order* v = order(n->val);
                 node_pool_.release(n);
                 --size_;
                 return v;
             }
+            prev = n;
+            r = n->next;
         }
         return nullptr;
     }
 
-   private:
-    struct Node {
-        uint64_t key;
-        Order* val;
-        Node* next;
-    };
-
-    size_t bucketOf(uint64_t id) const { return static_cast<size_t>((id * GOLDEN) >> shift_); }
+    // Push every node of a chain onto its bucket in the current array.
+    void relink(NodeRef head) {
+        while (head != kNoNode) {
+            Node* n = node(head);
+            const NodeRef next = n->next;
+            size_t b = bucketOf(n->key);
+            n->next = buckets_[b];
+            buckets_[b] = head;
+            head = next;
+        }
+    }
 
     void setCapacity(size_t cap) {
+        buckets_.assign(cap, kNoNode);
+        setShape(cap);
+    }
+
+    // Hash shift and thresholds for a cap-bucket array already in buckets_.
+    void setShape(size_t cap) {
         cap_ = cap;
         unsigned log2cap = 0;
         while ((size_t(1) << log2cap) < cap) ++log2cap;
         shift_ = 64u - log2cap;  // top log2cap bits of the product select a bucket
-        buckets_.assign(cap, nullptr);
         grow_threshold_ = (cap * 7) / 10;  // load factor ~0.7
+        prepare_threshold_ = Incremental ? grow_threshold_ / 2 : SIZE_MAX;
+        std::vector<NodeRef>().swap(next_buckets_);
     }
 
     // Double the bucket array and re-link every node (nodes themselves are kept).
+    // A migration in flight is finished first.
     void rehash(size_t new_cap) {
-#ifdef FIBHASH_COUNT_REHASH
-        ++rehash_count_;
-#endif
-        std::vector<Node*> old = std::move(buckets_);
+        if (migrating()) migrate(old_buckets_.size());
+        rehashes_.store(rehashes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::vector<NodeRef> old = std::move(buckets_);
         setCapacity(new_cap);
-        for (Node* head : old) {
-            while (head != nullptr) {
-                Node* next = head->next;
-                size_t b = bucketOf(head->key);
-                head->next = buckets_[b];
-                buckets_[b] = head;
-                head = next;
-            }
+        for (NodeRef head : old) relink(head);
+    }
+
+    // Incremental growth: switch to a new_cap bucket array and leave the nodes
+    // in the old one for migrate() to move.
+    void beginRehash(size_t new_cap) {
+        // Cannot happen under the load factor; kept so a migration is never lost.
+        if (migrating()) migrate(old_buckets_.size());
+        rehashes_.store(rehashes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // Normally prepare() has the whole array ready; finish it if not.
+        prepare(new_cap);
+        old_buckets_ = std::move(buckets_);
+        old_shift_ = shift_;
+        migrated_ = 0;
+        buckets_ = std::move(next_buckets_);
+        setShape(new_cap);
+    }
+
+    // Clear up to n more entries of the doubled bucket array. Its memory is
+    // reserved on the first call, so the page faults of clearing it are spread
+    // over these calls too.
+    void prepare(size_t n) {
+        const size_t want = cap_ << 1;
+        if (next_buckets_.capacity() < want) {
+            next_buckets_.reserve(want);
+        }
+        next_buckets_.resize(std::min(want, next_buckets_.size() + n), kNoNode);
+    }
+
+    // Move up to n old buckets into the current array; frees the old array
+    // once the last one is moved.
+    void migrate(size_t n) {
+        const size_t end = std::min(old_buckets_.size(), migrated_ + n);
+        for (; migrated_ < end; ++migrated_) {
+            relink(old_buckets_[migrated_]);
+            old_buckets_[migrated_] = kNoNode;
+        }
+        if (migrated_ == old_buckets_.size()) {
+            std::vector<NodeRef>().swap(old_buckets_);
+        }
+    }
+
+    Node* node(NodeRef r) const {
+        if constexpr (Compact) {
+            return node_pool_.get(r);
+        } else {
+            return r;
         }
     }
 
-    std::vector<Node*> buckets_;
+    NodeRef ref(Node* n) const {
+        if constexpr (Compact) {
+            return node_pool_.handle(n);
+        } else {
+            return n;
+        }
+    }
+
+    Order* order(OrderRef r) const {
+        if constexpr (Compact) {
+            return order_pool_->get(r);
+        } else {
+            return r;
+        }
+    }
+
+    OrderRef ref(Order* o) const {
+        if constexpr (Compact) {
+            assert(order_pool_->handle(o) != pool::kNullHandle && "CompactFibHashIndex holds an order from another pool");
+            return order_pool_->handle(o);
+        } else {
+            return o;
+        }
+    }
+
+    std::vector<NodeRef> buckets_;
     size_t cap_ = 0;
     unsigned shift_ = 0;
+    // Incremental mode only: the array being drained and the next bucket of it
+    // to move. Empty when no migration is running.
+    std::vector<NodeRef> old_buckets_;
+    unsigned old_shift_ = 0;
+    size_t migrated_ = 0;
+    // Incremental mode only: the doubled array prepare() is clearing ahead of
+    // growth.
+    std::vector<NodeRef> next_buckets_;
     size_t size_ = 0;
     size_t grow_threshold_ = 0;
-    pool::ObjectPool<Node> node_pool_;
-#ifdef FIBHASH_COUNT_REHASH
-   public:
-    size_t rehash_count_ = 0;  // test-only: confirms the rehash path is exercised
-#endif
+    size_t prepare_threshold_ = SIZE_MAX;
+    const OrderPool* order_pool_;
+    NodePool node_pool_;
+    std::atomic<uint64_t> rehashes_{0};
 };
 
+using FibHashIndex = BasicFibHashIndex<false>;
+using CompactFibHashIndex = BasicFibHashIndex<true>;
+using IncrementalFibHashIndex = BasicFibHashIndex<false, true>;
+
 }  // namespace index
 }  // namespace orderbook
@@ -1,44 +1,157 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <span>
 #include <sstream>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "array_levels.hpp"
 #include "level_store.hpp"
+#include "market_data.hpp"
 #include "object_pool.hpp"
 #include "order_index.hpp"
 #include "pricelevel.hpp"
+#include "queue_positions.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
 #include "types.hpp"
 #include "util.hpp"
 
 namespace orderbook {
 
-using OrderMap = index::FibHashIndex;
+// Stages of the software-prefetch pipeline processBatch runs ahead of
+// execution. Each stage only touches memory the previous stage pulled in, so
+// issuing them for the same command at decreasing lookahead turns the
+// bucket -> node -> Order chain of dependent misses into overlapped ones.
+//
+// Only a resting Add's level is prefetched: a Modify does not name its side, so
+// its target level is not known until the order is found.
+enum class PrefetchStage : uint8_t {
+    Bucket,  // index bucket slot; an Add's level slot
+    Node,    // index head node
+    Order,   // an Add's OrderQueue; for Cancel/Modify, the resting Order, found
+             // with a full index lookup over the bucket and node now cached
+};
 
 // Levels is the compile-time price-level container policy (a template over
 // PriceType). It defaults to ArrayLevels (tick array + bitmap); pass
 // RbTreeLevels to select the boost::intrusive::rbtree backend instead. The
 // selection is fully static, so there is no virtual dispatch on the hot path.
-template <class Notification, template <PriceType> class Levels = ArrayLevels>
+//
+// MarketData is the compile-time market-data policy (see market_data.hpp). The
+// default NoMarketData publishes nothing and compiles the tracking away; a
+// LevelListener receives the per-command L2 delta stream.
+//
+// Stats is the compile-time instrumentation policy (see stats.hpp). The
+// default NoStats compiles the hot-path counters away; CountingStats keeps
+// them. Either way stats() returns a BookStats copy.
+//
+// Index is the compile-time OrderID -> Order* map (see order_index.hpp), built
+// from the book's order pool and the order_index_reserve hint. The default
+// FibHashIndex links with pointers; CompactFibHashIndex links with 32-bit pool
+// handles for about half the index memory per resting order;
+// IncrementalFibHashIndex spreads each bucket-array doubling over later writes;
+// SwissIndex (swiss_index.hpp) stores entries inline in an open-addressing
+// table; DirectIndex (direct_index.hpp) maps dense ids through a paged array.
+template <class Notification, template <PriceType> class Levels = ArrayLevels, class MarketData = NoMarketData, class Stats = NoStats,
+          class Index = index::FibHashIndex>
 class OrderBook {
    public:
+    // order_slabs backs the order pool and the index's node pool, if it has
+    // one; level_slabs backs both sides' level pools (see pool::SlabPolicy).
     OrderBook(NotificationInterface<Notification>& n, size_t price_level_pool_size = 16384, size_t order_pool_size = 16384, size_t order_index_reserve = 16384,
-              uint64_t base_fp = 0, uint64_t tick_fp = 100000000, size_t num_ticks = 1 << 16)
-        : order_pool_(order_pool_size),
+              uint64_t base_fp = 0, uint64_t tick_fp = 100000000, size_t num_ticks = 1 << 16, const pool::SlabPolicy& order_slabs = {},
+              const pool::SlabPolicy& level_slabs = {})
+        : order_pool_(order_pool_size, order_slabs),
           notification_(static_cast<Notification&>(n)),
-          bids_(LevelStoreConfig{price_level_pool_size, base_fp, tick_fp, num_ticks}),
-          asks_(LevelStoreConfig{price_level_pool_size, base_fp, tick_fp, num_ticks}),
-          orders_(order_index_reserve) {};
+          bids_(LevelStoreConfig{price_level_pool_size, base_fp, tick_fp, num_ticks, level_slabs}),
+          asks_(LevelStoreConfig{price_level_pool_size, base_fp, tick_fp, num_ticks, level_slabs}),
+          orders_(order_pool_, order_index_reserve),
+          base_fp_(base_fp),
+          tick_fp_(tick_fp) {};
 
     void addOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag);
     void putTradeNotification(OrderID mOrderID, OrderID tOrderID, OrderStatus mStatus, OrderStatus tStatus, Decimal qty, Decimal price);
     void cancelOrder(OrderID id);
+    void modifyOrder(OrderID id, Decimal qty, Decimal price);
     bool hasOrder(OrderID id);
+
+    // Handle-based API, usable alongside the id-based one (see OrderHandle).
+    // addOrder(..., with_handle) behaves exactly like addOrder and returns a
+    // handle to the order if it rests. The overloads below find the order
+    // through the handle instead of the index. Reports are identical; a stale
+    // handle is rejected with ErrOrderNotExists. A cancel still unlinks the
+    // id from the index, so the saving is the lookup in modifyOrder and the
+    // market-data lookup in cancelOrder.
+    OrderHandle addOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag, WithHandle);
+    void cancelOrder(OrderHandle handle);
+    void modifyOrder(OrderHandle handle, Decimal qty, Decimal price);
+    bool hasOrder(OrderHandle handle) const;
+
+    // Top of book, O(1): best level price, aggregate qty and order count (empty()
+    // when the side has no orders). spread() is bestAsk - bestBid, or nullopt
+    // unless both sides are populated.
+    LevelInfo bestBid();
+    LevelInfo bestAsk();
+    std::optional<Decimal> spread();
+
+    // Single-level queries served from the level store (O(1) with ArrayLevels,
+    // O(log N) with RbTreeLevels): total resting qty and order count at price
+    // on side's book. A price with no level reports zero / empty().
+    Decimal depthAt(Side side, Decimal price);
+    LevelInfo levelInfo(Side side, Decimal price);
+
+    // apply dispatches a single Command to addOrder / cancelOrder / modifyOrder.
+    // processBatch applies cmds in order with exactly the reports and book state
+    // of calling apply on each, while prefetching the index bucket, node and
+    // Order/level of the commands a few slots ahead.
+    void apply(const Command& cmd);
+    void processBatch(std::span<const Command> cmds);
+    void prefetch(const Command& cmd, PrefetchStage stage) const;
+
+    // Lookahead, in commands, at which processBatch issues each PrefetchStage.
+    static constexpr size_t kPrefetchBucketAhead = 12;
+    static constexpr size_t kPrefetchNodeAhead = 8;
+    static constexpr size_t kPrefetchOrderAhead = 4;
+
     void setMatching(bool matching) { matching_ = matching; }
 
+    // Binary snapshot of every resting order (FIFO order per level), last_price,
+    // the matching flag and the tick grid; format in snapshot.hpp. loadSnapshot
+    // only restores into an empty book built with the same tick grid and places
+    // orders directly, without matching or reports. It validates the whole
+    // snapshot before touching the book and returns false, leaving the book
+    // unchanged, on a bad header, truncated data or a duplicate order id.
+    bool saveSnapshot(std::ostream& os);
+    bool loadSnapshot(std::istream& is);
+
     std::string toString();
 
+    MarketData& marketData() { return market_data_; }
+
+    // Counters as of now. Safe to call from any thread, e.g. a monitor polling
+    // a book that an EngineRunner drives; each field is read atomically, but
+    // fields are not sampled at one instant relative to each other.
+    BookStats stats() const;
+
+    // Once a spike has drained, give pool slabs that no longer hold anything
+    // back to the OS: the order pool's and, for an index with a node pool, the
+    // index's (see pool::ObjectPool::trim). Each keeps at least keep_free free
+    // slots. One call walks at most max_slots free slots of each pool, so a
+    // maintenance window can trim in one call and a busy book in steps at
+    // quiet moments on its thread, until trimming() is false. Returns the
+    // bytes released.
+    size_t trim(size_t keep_free = 0, size_t max_slots = SIZE_MAX);
+    bool trimming() const;
+
     Decimal last_price;
 
    private:
@@ -47,119 +160,124 @@ class OrderBook {
     PriceLevel<PriceType::Bid, Levels<PriceType::Bid>> bids_;
     PriceLevel<PriceType::Ask, Levels<PriceType::Ask>> asks_;
 
-    OrderMap orders_;
+    Index orders_;
 
     Notification& notification_;
 
     bool matching_ = true;
 
+    // Per order-pool slot, the generation of the live order's handle; 0 when
+    // the slot holds no handled order. Sized on demand by issueHandle.
+    std::vector<uint32_t> handle_generations_;
+    uint32_t next_generation_ = 0;
+
+    uint64_t base_fp_;
+    uint64_t tick_fp_;
+
+    [[no_unique_address]] MarketData market_data_;
+    [[no_unique_address]] std::conditional_t<LevelListener<MarketData>, LevelDeltaTracker, NoLevelTracking> level_deltas_;
+    [[no_unique_address]] std::conditional_t<OrderListener<MarketData>, OrderEventBuffer, NoOrderEvents> order_events_;
+    [[no_unique_address]] std::conditional_t<OrderListener<MarketData>, QueuePositions, NoQueuePositions> positions_;
+    [[no_unique_address]] Stats stats_;
+
+    void touchLevel(Side side, const Decimal& price);
+    void recordAdd(const Order* order);
+    void recordInPlace(OrderEventType type, const Order* order, Decimal qty, Decimal leaves_qty);
+    void recordLeave(const Order* order);
+    void recordExecution(OrderID id, Side side, Decimal qty, Decimal price);
+    void publishMarketData();
+
     std::pair<Decimal, Decimal> eraseOrder(OrderID id);
-    void processOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag);
+    std::pair<Decimal, Decimal> removeOrder(Order* order);
+    void releaseOrder(Order* order);
+    void putRejection(MsgType msgType, OrderID id, Decimal qty, Decimal original_qty, Error err);
+    void putCancel(OrderID id, Decimal qty, Decimal original_qty);
+    Order* submitOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag);
+    Order* processOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag);
+    void amendOrder(Order* order, Decimal qty, Decimal price);
+    OrderHandle issueHandle(Order* order);
+    Order* resolve(OrderHandle handle) const;
+
+    // A limit or amend price the level store can hold: non-zero and, for a
+    // store with a tick grid, on it (both sides share the grid).
+    bool validPrice(const Decimal& price) const { return !price.is_zero() && bids_.store().onGrid(price); }
 };
 
-template <class Notification, template <PriceType> class Levels>
-void OrderBook<Notification, Levels>::addOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) {
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::addOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) {
+    submitOrder(id, type, side, qty, price, flag);
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+OrderHandle OrderBook<Notification, Levels, MarketData, Stats, Index>::addOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag,
+                                                                                WithHandle) {
+    Order* order = submitOrder(id, type, side, qty, price, flag);
+    return order != nullptr ? issueHandle(order) : OrderHandle{.id = id};
+}
+
+// addOrder's body; returns the order if it rested.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+Order* OrderBook<Notification, Levels, MarketData, Stats, Index>::submitOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) {
     if (qty.is_zero()) [[unlikely]] {
-        notification_.onExecutionReport(ExecutionReport{
-            .exec_type = ExecType::Rejected,
-            .msg_type = MsgType::CreateOrder,
-            .order_id = id,
-            .status = OrderStatus::Rejected,
-            .qty = qty,
-            .original_qty = qty,
-            .error = Error::InvalidQty,
-        });
-        return;
+        putRejection(MsgType::CreateOrder, id, qty, qty, Error::InvalidQty);
+        return nullptr;
     }
 
     if (!matching_) [[unlikely]] {
         if (type == Type::Market) {
-            notification_.onExecutionReport(ExecutionReport{
-                .exec_type = ExecType::Rejected,
-                .msg_type = MsgType::CreateOrder,
-                .order_id = id,
-                .status = OrderStatus::Rejected,
-                .qty = qty,
-                .original_qty = qty,
-                .error = Error::NoMatching,
-            });
-            return;
+            putRejection(MsgType::CreateOrder, id, qty, qty, Error::NoMatching);
+            return nullptr;
         }
 
         if (side == Side::Buy) {
             auto q = asks_.getQueue();
             if (q != nullptr && q->price() <= price) {
-                notification_.onExecutionReport(ExecutionReport{
-                    .exec_type = ExecType::Rejected,
-                    .msg_type = MsgType::CreateOrder,
-                    .order_id = id,
-                    .status = OrderStatus::Rejected,
-                    .qty = qty,
-                    .original_qty = qty,
-                    .error = Error::NoMatching,
-                });
-                return;
+                putRejection(MsgType::CreateOrder, id, qty, qty, Error::NoMatching);
+                return nullptr;
             }
         } else {
             auto q = bids_.getQueue();
             if (q != nullptr && q->price() >= price) {
-                notification_.onExecutionReport(ExecutionReport{
-                    .exec_type = ExecType::Rejected,
-                    .msg_type = MsgType::CreateOrder,
-                    .order_id = id,
-                    .status = OrderStatus::Rejected,
-                    .qty = qty,
-                    .original_qty = qty,
-                    .error = Error::NoMatching,
-                });
-                return;
+                putRejection(MsgType::CreateOrder, id, qty, qty, Error::NoMatching);
+                return nullptr;
             }
         }
     }
 
     if (type != Type::Market) {
         if (orders_.contains(id)) {
-            notification_.onExecutionReport(ExecutionReport{
-                .exec_type = ExecType::Rejected,
-                .msg_type = MsgType::CreateOrder,
-                .order_id = id,
-                .status = OrderStatus::Rejected,
-                .qty = uint64_t(0),
-                .original_qty = qty,
-                .error = Error::OrderExists,
-            });
-            return;
+            putRejection(MsgType::CreateOrder, id, uint64_t(0), qty, Error::OrderExists);
+            return nullptr;
         }
 
-        if (price.is_zero()) {
-            notification_.onExecutionReport(ExecutionReport{
-                .exec_type = ExecType::Rejected,
-                .msg_type = MsgType::CreateOrder,
-                .order_id = id,
-                .status = OrderStatus::Rejected,
-                .qty = uint64_t(0),
-                .original_qty = qty,
-                .error = Error::InvalidPrice,
-            });
-            return;
+        if (!validPrice(price)) {
+            putRejection(MsgType::CreateOrder, id, uint64_t(0), qty, Error::InvalidPrice);
+            return nullptr;
         }
     }
 
-    notification_.onExecutionReport(ExecutionReport{
-        .exec_type = ExecType::New,
-        .msg_type = MsgType::CreateOrder,
+    notification_.onNew(OrderReport{
         .order_id = id,
-        .status = OrderStatus::Accepted,
         .qty = qty,
         .original_qty = qty,
+        .msg_type = MsgType::CreateOrder,
     });
-    processOrder(id, type, side, qty, price, flag);
+    stats_.onAdd();
+    stats_.beginSweep();
+    Order* order = processOrder(id, type, side, qty, price, flag);
+    stats_.endSweep();
+    publishMarketData();
+    return order;
 }
 
-template <class Notification, template <PriceType> class Levels>
-void OrderBook<Notification, Levels>::processOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) {
-    const auto tradeNotification = [this](OrderID mOrderID, OrderID tOrderID, OrderStatus mOrderStatus, OrderStatus tOrderStatus, Decimal qty, Decimal price) {
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+Order* OrderBook<Notification, Levels, MarketData, Stats, Index>::processOrder(OrderID id, Type type, Side side, Decimal qty, Decimal price, Flag flag) {
+    const Side makerSide = side == Side::Buy ? Side::Sell : Side::Buy;
+    const auto tradeNotification = [this, makerSide](OrderID mOrderID, OrderID tOrderID, OrderStatus mOrderStatus, OrderStatus tOrderStatus, Decimal qty, Decimal price) {
         this->putTradeNotification(mOrderID, tOrderID, mOrderStatus, tOrderStatus, qty, price);
+        this->touchLevel(makerSide, price);
+        this->recordExecution(mOrderID, makerSide, qty, price);
+        this->stats_.onFill(price);
         this->last_price = price;
     };
     const auto postOrderFill = [this](OrderID id) { this->eraseOrder(id); };
@@ -171,7 +289,7 @@ void OrderBook<Notification, Levels>::processOrder(OrderID id, Type type, Side s
             bids_.processMarketOrder(tradeNotification, postOrderFill, id, qty, flag);
         }
 
-        return;
+        return nullptr;
     }
 
     Decimal qtyProcessed;
@@ -182,7 +300,7 @@ void OrderBook<Notification, Levels>::processOrder(OrderID id, Type type, Side s
     }
 
     if ((flag & (IoC | FoK)) != 0) {
-        return;
+        return nullptr;
     }
 
     auto qtyLeft = qty - qtyProcessed;
@@ -194,78 +312,689 @@ void OrderBook<Notification, Levels>::processOrder(OrderID id, Type type, Side s
         } else {
             asks_.append(o);
         }
+        touchLevel(side, price);
+        recordAdd(o);
 
         orders_.insert(id, o);
+        stats_.onLiveOrders(orders_.size());
+        return o;
     }
 
-    return;
+    return nullptr;
 }
 
-template <class Notification, template <PriceType> class Levels>
-void OrderBook<Notification, Levels>::putTradeNotification(OrderID mOrderID, OrderID tOrderID, OrderStatus mStatus, OrderStatus tStatus, Decimal qty, Decimal price) {
-    notification_.onExecutionReport(ExecutionReport{
-        .exec_type = ExecType::Trade,
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::putTradeNotification(OrderID mOrderID, OrderID tOrderID, OrderStatus mStatus, OrderStatus tStatus, Decimal qty, Decimal price) {
+    notification_.onTrade(TradeReport{
         .maker_order_id = mOrderID,
         .taker_order_id = tOrderID,
+        .qty = qty,
+        .price = price,
         .maker_status = mStatus,
         .taker_status = tStatus,
-        .last_qty = qty,
-        .last_price = price,
     });
 }
 
-template <class Notification, template <PriceType> class Levels>
-void OrderBook<Notification, Levels>::cancelOrder(OrderID id) {
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::cancelOrder(OrderID id) {
+    if constexpr (OrderListener<MarketData>) {
+        if (const auto* order = orders_.find(id); order != nullptr) {
+            recordInPlace(OrderEventType::Delete, order, order->qty, uint64_t(0));
+        }
+    }
+
     auto [qty, original_qty] = eraseOrder(id);
     if (qty.is_zero()) {
-        notification_.onExecutionReport(ExecutionReport{
-            .exec_type = ExecType::Rejected,
-            .msg_type = MsgType::CancelOrder,
+        putRejection(MsgType::CancelOrder, id, uint64_t(0), uint64_t(0), Error::OrderNotExists);
+        return;
+    }
+    putCancel(id, qty, original_qty);
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::cancelOrder(OrderHandle handle) {
+    auto* order = resolve(handle);
+    if (order == nullptr) {
+        putRejection(MsgType::CancelOrder, handle.id, uint64_t(0), uint64_t(0), Error::OrderNotExists);
+        return;
+    }
+    if constexpr (OrderListener<MarketData>) {
+        recordInPlace(OrderEventType::Delete, order, order->qty, uint64_t(0));
+    }
+
+    orders_.erase(handle.id);
+    auto [qty, original_qty] = removeOrder(order);
+    putCancel(handle.id, qty, original_qty);
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::putCancel(OrderID id, Decimal qty, Decimal original_qty) {
+    notification_.onCancel(OrderReport{
+        .order_id = id,
+        .qty = qty,
+        .original_qty = original_qty,
+        .msg_type = MsgType::CancelOrder,
+    });
+    stats_.onCancel();
+    publishMarketData();
+}
+
+// Amend a resting order to qty/price, keeping the same Order object and index
+// entry. Same price, qty down: reduced in place, time priority kept. Same price,
+// qty up: moved to the back of its queue. New price: pulled from its level and
+// re-entered at the new price, matching first if it now crosses (the order is
+// the taker). qty is the new open quantity and becomes original_qty.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::modifyOrder(OrderID id, Decimal qty, Decimal price) {
+    if (qty.is_zero()) [[unlikely]] {
+        putRejection(MsgType::ModifyOrder, id, qty, qty, Error::InvalidQty);
+        return;
+    }
+
+    if (!validPrice(price)) [[unlikely]] {
+        putRejection(MsgType::ModifyOrder, id, uint64_t(0), qty, Error::InvalidPrice);
+        return;
+    }
+
+    auto* order = orders_.find(id);
+    if (order == nullptr) {
+        putRejection(MsgType::ModifyOrder, id, uint64_t(0), qty, Error::OrderNotExists);
+        return;
+    }
+    amendOrder(order, qty, price);
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::modifyOrder(OrderHandle handle, Decimal qty, Decimal price) {
+    if (qty.is_zero()) [[unlikely]] {
+        putRejection(MsgType::ModifyOrder, handle.id, qty, qty, Error::InvalidQty);
+        return;
+    }
+
+    if (!validPrice(price)) [[unlikely]] {
+        putRejection(MsgType::ModifyOrder, handle.id, uint64_t(0), qty, Error::InvalidPrice);
+        return;
+    }
+
+    auto* order = resolve(handle);
+    if (order == nullptr) {
+        putRejection(MsgType::ModifyOrder, handle.id, uint64_t(0), qty, Error::OrderNotExists);
+        return;
+    }
+    amendOrder(order, qty, price);
+}
+
+// modifyOrder's body once the order is found.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::amendOrder(Order* order, Decimal qty, Decimal price) {
+    const OrderID id = order->id;
+    const Side side = order->side;
+    if (price == order->price) {
+        if (qty < order->qty) {
+            recordInPlace(OrderEventType::Reduce, order, order->qty - qty, qty);
+            if (side == Side::Buy) {
+                bids_.reduce(order, qty);
+            } else {
+                asks_.reduce(order, qty);
+            }
+            touchLevel(side, price);
+        } else if (qty > order->qty) {
+            recordInPlace(OrderEventType::Delete, order, order->qty, uint64_t(0));
+            recordLeave(order);
+            if (side == Side::Buy) {
+                bids_.requeue(order, qty);
+            } else {
+                asks_.requeue(order, qty);
+            }
+            touchLevel(side, price);
+            recordAdd(order);
+        }
+        order->original_qty = qty;
+
+        notification_.onReplace(OrderReport{
             .order_id = id,
-            .status = OrderStatus::Rejected,
-            .qty = uint64_t(0),
-            .original_qty = uint64_t(0),
-            .error = Error::OrderNotExists,
+            .qty = qty,
+            .original_qty = qty,
+            .msg_type = MsgType::ModifyOrder,
         });
+        stats_.onModify();
+        publishMarketData();
         return;
     }
 
-    notification_.onExecutionReport(ExecutionReport{
-        .exec_type = ExecType::Canceled,
-        .msg_type = MsgType::CancelOrder,
+    if (!matching_) [[unlikely]] {
+        if (side == Side::Buy) {
+            auto q = asks_.getQueue();
+            if (q != nullptr && q->price() <= price) {
+                putRejection(MsgType::ModifyOrder, id, qty, qty, Error::NoMatching);
+                return;
+            }
+        } else {
+            auto q = bids_.getQueue();
+            if (q != nullptr && q->price() >= price) {
+                putRejection(MsgType::ModifyOrder, id, qty, qty, Error::NoMatching);
+                return;
+            }
+        }
+    }
+
+    recordInPlace(OrderEventType::Delete, order, order->qty, uint64_t(0));
+    recordLeave(order);
+    if (side == Side::Buy) {
+        bids_.remove(order);
+    } else {
+        asks_.remove(order);
+    }
+    touchLevel(side, order->price);
+    order->price = price;
+    order->original_qty = qty;
+
+    notification_.onReplace(OrderReport{
+        .order_id = id,
+        .qty = qty,
+        .original_qty = qty,
+        .msg_type = MsgType::ModifyOrder,
+    });
+    stats_.onModify();
+
+    const Side makerSide = side == Side::Buy ? Side::Sell : Side::Buy;
+    const auto tradeNotification = [this, makerSide](OrderID mOrderID, OrderID tOrderID, OrderStatus mOrderStatus, OrderStatus tOrderStatus, Decimal qty, Decimal price) {
+        this->putTradeNotification(mOrderID, tOrderID, mOrderStatus, tOrderStatus, qty, price);
+        this->touchLevel(makerSide, price);
+        this->recordExecution(mOrderID, makerSide, qty, price);
+        this->stats_.onFill(price);
+        this->last_price = price;
+    };
+    const auto postOrderFill = [this](OrderID id) { this->eraseOrder(id); };
+
+    Decimal qtyProcessed;
+    stats_.beginSweep();
+    if (side == Side::Buy) {
+        qtyProcessed = asks_.processLimitOrder(tradeNotification, postOrderFill, id, price, qty, order->flag);
+    } else {
+        qtyProcessed = bids_.processLimitOrder(tradeNotification, postOrderFill, id, price, qty, order->flag);
+    }
+    stats_.endSweep();
+
+    auto qtyLeft = qty - qtyProcessed;
+    if (qtyLeft.is_zero()) {
+        orders_.erase(id);
+        releaseOrder(order);
+        stats_.onLiveOrders(orders_.size());
+    } else {
+        order->qty = qtyLeft;
+        if (side == Side::Buy) {
+            bids_.append(order);
+        } else {
+            asks_.append(order);
+        }
+        touchLevel(side, price);
+        recordAdd(order);
+    }
+    publishMarketData();
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::apply(const Command& cmd) {
+    switch (cmd.kind) {
+        case CommandType::Add:
+            addOrder(cmd.id, cmd.type, cmd.side, cmd.qty, cmd.price, cmd.flag);
+            break;
+        case CommandType::Cancel:
+            cancelOrder(cmd.id);
+            break;
+        case CommandType::Modify:
+            modifyOrder(cmd.id, cmd.qty, cmd.price);
+            break;
+    }
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::processBatch(std::span<const Command> cmds) {
+    // Start kPrefetchBucketAhead slots early so the first commands of the batch
+    // have been through every stage too.
+    const auto n = static_cast<ptrdiff_t>(cmds.size());
+    for (ptrdiff_t i = -static_cast<ptrdiff_t>(kPrefetchBucketAhead); i < n; ++i) {
+        if (const ptrdiff_t j = i + kPrefetchBucketAhead; j >= 0 && j < n) {
+            prefetch(cmds[j], PrefetchStage::Bucket);
+        }
+        if (const ptrdiff_t j = i + kPrefetchNodeAhead; j >= 0 && j < n) {
+            prefetch(cmds[j], PrefetchStage::Node);
+        }
+        if (const ptrdiff_t j = i + kPrefetchOrderAhead; j >= 0 && j < n) {
+            prefetch(cmds[j], PrefetchStage::Order);
+        }
+        if (i >= 0) {
+            apply(cmds[i]);
+        }
+    }
+}
+
+// Prefetches are pure hints: they read the index and level arrays as they are
+// now, never dereference an Order, and so cannot change what apply() does even
+// when an earlier command in the batch inserts or erases the same id or level.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::prefetch(const Command& cmd, PrefetchStage stage) const {
+    if (cmd.kind == CommandType::Add && cmd.type == Type::Market) {
+        return;  // never indexed, never rests
+    }
+
+    switch (stage) {
+        case PrefetchStage::Bucket:
+            orders_.prefetchBucket(cmd.id);
+            if (cmd.kind == CommandType::Add) {
+                if (cmd.side == Side::Buy) {
+                    bids_.prefetchSlot(cmd.price);
+                } else {
+                    asks_.prefetchSlot(cmd.price);
+                }
+            }
+            break;
+        case PrefetchStage::Node:
+            orders_.prefetchNode(cmd.id);
+            break;
+        case PrefetchStage::Order:
+            if (cmd.kind == CommandType::Add) {
+                if (cmd.side == Side::Buy) {
+                    bids_.prefetchQueue(cmd.price);
+                } else {
+                    asks_.prefetchQueue(cmd.price);
+                }
+            } else if (const Order* o = orders_.find(cmd.id); o != nullptr) {
+                __builtin_prefetch(o);
+            }
+            break;
+    }
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::putRejection(MsgType msgType, OrderID id, Decimal qty, Decimal original_qty, Error err) {
+    notification_.onReject(RejectReport{
         .order_id = id,
-        .status = OrderStatus::Canceled,
         .qty = qty,
         .original_qty = original_qty,
+        .msg_type = msgType,
+        .error = err,
     });
+    stats_.onReject(err);
 }
 
-template <class Notification, template <PriceType> class Levels>
-std::pair<Decimal, Decimal> OrderBook<Notification, Levels>::eraseOrder(OrderID id) {
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+std::pair<Decimal, Decimal> OrderBook<Notification, Levels, MarketData, Stats, Index>::eraseOrder(OrderID id) {
     auto* order = orders_.erase(id);
     if (order == nullptr) {
         return {uint64_t(0), uint64_t(0)};
     }
+    return removeOrder(order);
+}
 
+// Take an order that is already out of the index off its level and return it
+// to the pool; returns its open and original qty.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+std::pair<Decimal, Decimal> OrderBook<Notification, Levels, MarketData, Stats, Index>::removeOrder(Order* order) {
     const Decimal qty = order->qty;
     const Decimal original_qty = order->original_qty;
+    recordLeave(order);
     if (order->side == Side::Buy) {
         bids_.remove(order);
     } else {
         asks_.remove(order);
     }
+    touchLevel(order->side, order->price);
 
-    order_pool_.release(order);
+    releaseOrder(order);
+    stats_.onLiveOrders(orders_.size());
     return {qty, original_qty};
 }
 
-template <class Notification, template <PriceType> class Levels>
-bool OrderBook<Notification, Levels>::hasOrder(OrderID id) {
+// Every resting order goes back to the pool through here, which retires its
+// handle first.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::releaseOrder(Order* order) {
+    if (order->generation != 0) [[unlikely]] {
+        handle_generations_[order_pool_.handle(order)] = 0;
+    }
+    order_pool_.release(order);
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+OrderHandle OrderBook<Notification, Levels, MarketData, Stats, Index>::issueHandle(Order* order) {
+    const auto slot = order_pool_.handle(order);
+    if (slot >= handle_generations_.size()) {
+        handle_generations_.resize(std::max<size_t>(size_t{slot} + 1, handle_generations_.size() * 2), 0);
+    }
+    // 0 marks a slot without a live handle, so the counter skips it on wrap.
+    if (++next_generation_ == 0) {
+        ++next_generation_;
+    }
+    order->generation = next_generation_;
+    handle_generations_[slot] = next_generation_;
+    return {.id = order->id, .slot = slot, .generation = next_generation_};
+}
+
+// The order a handle names, or nullptr if that order has left the book. A
+// matching generation means the slot still holds the order the handle was
+// issued for; the id check rejects a handle whose id was altered.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+Order* OrderBook<Notification, Levels, MarketData, Stats, Index>::resolve(OrderHandle handle) const {
+    if (handle.null() || handle.slot >= handle_generations_.size() || handle_generations_[handle.slot] != handle.generation) {
+        return nullptr;
+    }
+    Order* order = order_pool_.get(handle.slot);
+    return order->id == handle.id ? order : nullptr;
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::touchLevel(Side side, const Decimal& price) {
+    if constexpr (LevelListener<MarketData>) {
+        level_deltas_.touch(side, price);
+    }
+}
+
+// An order just appended to its level; it sits at the back of the FIFO.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::recordAdd(const Order* order) {
+    if constexpr (OrderListener<MarketData>) {
+        order_events_.push({
+            .order_id = order->id,
+            .price = order->price,
+            .qty = order->qty,
+            .leaves_qty = order->qty,
+            .position = positions_.append(order_pool_, order->queue, order),
+            .side = order->side,
+            .type = OrderEventType::Add,
+        });
+    }
+}
+
+// A Reduce or Delete of an order still in its queue, recorded before the
+// change so its FIFO position can be read.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::recordInPlace(OrderEventType type, const Order* order, Decimal qty, Decimal leaves_qty) {
+    if constexpr (OrderListener<MarketData>) {
+        order_events_.push({
+            .order_id = order->id,
+            .price = order->price,
+            .qty = qty,
+            .leaves_qty = leaves_qty,
+            .position = positions_.position(order_pool_, order->queue, order),
+            .side = order->side,
+            .type = type,
+        });
+    }
+}
+
+// An order about to come off its queue, filled or not; keeps the positions of
+// the orders behind it current.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::recordLeave(const Order* order) {
+    if constexpr (OrderListener<MarketData>) {
+        positions_.leave(order_pool_, order->queue, order);
+    }
+}
+
+// Makers always trade from the front of their queue. A fully filled maker has
+// already been erased by the time its trade is reported, so it has no leaves.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::recordExecution(OrderID id, Side side, Decimal qty, Decimal price) {
+    if constexpr (OrderListener<MarketData>) {
+        const auto* order = orders_.find(id);
+        order_events_.push({
+            .order_id = id,
+            .price = price,
+            .qty = qty,
+            .leaves_qty = order != nullptr ? order->qty : Decimal{},
+            .position = 0,
+            .side = side,
+            .type = OrderEventType::Execute,
+        });
+    }
+}
+
+// Publish the market data of the command that just finished. Levels are read
+// back after the command, so an L2 update carries the level's final state, not
+// each intermediate step of a sweep.
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+void OrderBook<Notification, Levels, MarketData, Stats, Index>::publishMarketData() {
+    if constexpr (LevelListener<MarketData>) {
+        if (!level_deltas_.empty()) {
+            market_data_.onLevelUpdates(level_deltas_.collect([this](Side side, const Decimal& price) { return levelInfo(side, price); }));
+        }
+    }
+    if constexpr (OrderListener<MarketData>) {
+        if (!order_events_.empty()) {
+            market_data_.onOrderEvents(order_events_.events());
+            order_events_.clear();
+        }
+    }
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+bool OrderBook<Notification, Levels, MarketData, Stats, Index>::hasOrder(OrderID id) {
     return orders_.contains(id);
 }
 
-template <class Notification, template <PriceType> class Levels>
-std::string OrderBook<Notification, Levels>::toString() {
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+bool OrderBook<Notification, Levels, MarketData, Stats, Index>::hasOrder(OrderHandle handle) const {
+    return resolve(handle) != nullptr;
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+LevelInfo OrderBook<Notification, Levels, MarketData, Stats, Index>::bestBid() {
+    auto* q = bids_.getQueue();
+    if (q == nullptr) {
+        return {};
+    }
+    return {q->price(), q->totalQty(), q->len()};
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+LevelInfo OrderBook<Notification, Levels, MarketData, Stats, Index>::bestAsk() {
+    auto* q = asks_.getQueue();
+    if (q == nullptr) {
+        return {};
+    }
+    return {q->price(), q->totalQty(), q->len()};
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+std::optional<Decimal> OrderBook<Notification, Levels, MarketData, Stats, Index>::spread() {
+    auto* b = bids_.getQueue();
+    auto* a = asks_.getQueue();
+    if (b == nullptr || a == nullptr) {
+        return std::nullopt;
+    }
+    return a->price() - b->price();
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+Decimal OrderBook<Notification, Levels, MarketData, Stats, Index>::depthAt(Side side, Decimal price) {
+    auto* q = side == Side::Buy ? bids_.find(price) : asks_.find(price);
+    if (q == nullptr) {
+        return {};
+    }
+    return q->totalQty();
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+LevelInfo OrderBook<Notification, Levels, MarketData, Stats, Index>::levelInfo(Side side, Decimal price) {
+    auto* q = side == Side::Buy ? bids_.find(price) : asks_.find(price);
+    if (q == nullptr) {
+        return {};
+    }
+    return {q->price(), q->totalQty(), q->len()};
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+bool OrderBook<Notification, Levels, MarketData, Stats, Index>::saveSnapshot(std::ostream& os) {
+    snapshot::Header header;
+    header.matching = matching_ ? 1 : 0;
+    header.base_fp = base_fp_;
+    header.tick_fp = tick_fp_;
+    header.last_price = last_price.fp;
+    header.order_count = bids_.len() + asks_.len();
+    snapshot::putHeader(os, header);
+
+    const auto putSide = [&os](auto& side) {
+        snapshot::put<uint64_t>(os, side.depth());
+        for (auto* q = side.getQueue(); q != nullptr; q = side.getNextQueue(q->price())) {
+            snapshot::putDecimal(os, q->price());
+            snapshot::put<uint64_t>(os, q->len());
+            for (const Order& o : q->order_list()) {
+                snapshot::put<uint64_t>(os, o.id);
+                snapshot::putDecimal(os, o.qty);
+                snapshot::putDecimal(os, o.original_qty);
+                snapshot::put(os, static_cast<uint8_t>(o.type));
+                snapshot::put(os, static_cast<uint8_t>(o.flag));
+            }
+        }
+    };
+    putSide(bids_);
+    putSide(asks_);
+
+    return static_cast<bool>(os);
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+bool OrderBook<Notification, Levels, MarketData, Stats, Index>::loadSnapshot(std::istream& is) {
+    if (orders_.size() != 0) {
+        return false;
+    }
+
+    snapshot::Header header;
+    if (!snapshot::getHeader(is, header) || header.magic != snapshot::kMagic || header.version != snapshot::kVersion) {
+        return false;
+    }
+    if (header.base_fp != base_fp_ || header.tick_fp != tick_fp_) {
+        return false;
+    }
+
+    // Decode and validate everything first so a bad snapshot leaves the book
+    // untouched. order_count only sizes the buffer up to a bound, so a
+    // corrupt count fails the final check instead of the allocation.
+    constexpr uint64_t kMaxReserve = uint64_t{1} << 20;
+    std::vector<snapshot::OrderRecord> records;
+    records.reserve(std::min(header.order_count, kMaxReserve));
+    std::array<Decimal, 2> best{};
+    for (const Side side : {Side::Buy, Side::Sell}) {
+        uint64_t levels;
+        if (!snapshot::get(is, levels)) {
+            return false;
+        }
+        Decimal prev{};
+        for (uint64_t l = 0; l < levels; ++l) {
+            Decimal price;
+            uint64_t count;
+            if (!snapshot::getDecimal(is, price) || !snapshot::get(is, count) || !validPrice(price) || count == 0) {
+                return false;
+            }
+            // Levels are unique and best first: bids descending, asks ascending.
+            if (l == 0) {
+                best[static_cast<size_t>(side)] = price;
+            } else if (side == Side::Buy ? price >= prev : price <= prev) {
+                return false;
+            }
+            prev = price;
+            for (uint64_t i = 0; i < count; ++i) {
+                snapshot::OrderRecord r{};
+                r.price = price;
+                r.side = side;
+                uint8_t type;
+                uint8_t flag;
+                if (!snapshot::get(is, r.id) || !snapshot::getDecimal(is, r.qty) || !snapshot::getDecimal(is, r.original_qty) || !snapshot::get(is, type) ||
+                    !snapshot::get(is, flag) || r.qty.is_zero()) {
+                    return false;
+                }
+                if (type > static_cast<uint8_t>(Type::Market) || (flag & ~(IoC | AoN | FoK | Snapshot)) != 0) {
+                    return false;
+                }
+                r.type = static_cast<Type>(type);
+                r.flag = static_cast<Flag>(flag);
+                records.push_back(r);
+            }
+        }
+    }
+    if (records.size() != header.order_count) {
+        return false;
+    }
+    // A resting book is never crossed.
+    const Decimal& bid = best[static_cast<size_t>(Side::Buy)];
+    const Decimal& ask = best[static_cast<size_t>(Side::Sell)];
+    if (!bid.is_zero() && !ask.is_zero() && bid >= ask) {
+        return false;
+    }
+
+    std::vector<OrderID> ids;
+    ids.reserve(records.size());
+    for (const auto& r : records) {
+        ids.push_back(r.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    if (std::adjacent_find(ids.begin(), ids.end()) != ids.end()) {
+        return false;
+    }
+
+    // Records are level by level in FIFO order, so plain appends rebuild every
+    // queue exactly; the index is sized once up front.
+    orders_.reserve(records.size());
+    for (const auto& r : records) {
+        auto* o = order_pool_.acquire(r.id, r.type, r.side, r.qty, r.price, r.flag);
+        o->original_qty = r.original_qty;
+        if (r.side == Side::Buy) {
+            bids_.append(o);
+        } else {
+            asks_.append(o);
+        }
+        orders_.insert(r.id, o);
+    }
+    stats_.onLiveOrders(orders_.size());
+
+    last_price = decimalFromFp(header.last_price);
+    matching_ = header.matching != 0;
+    return true;
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+BookStats OrderBook<Notification, Levels, MarketData, Stats, Index>::stats() const {
+    BookStats s;
+    stats_.snapshot(s);
+    s.level_grows = bids_.store().grows() + asks_.store().grows();
+    s.index_rehashes = orders_.rehashes();
+    s.order_pool_slabs = order_pool_.slabs();
+    s.index_pool_slabs = orders_.slabs();
+    s.level_pool_slabs = bids_.store().slabs() + asks_.store().slabs();
+    return s;
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+size_t OrderBook<Notification, Levels, MarketData, Stats, Index>::trim(size_t keep_free, size_t max_slots) {
+    // Both pools start a pass together; one that has finished waits for the
+    // other rather than starting again.
+    const bool fresh = !trimming();
+    size_t bytes = 0;
+    if (fresh || order_pool_.trimming()) {
+        bytes += order_pool_.trim(keep_free, max_slots);
+    }
+    if constexpr (requires { orders_.trim(keep_free, max_slots); }) {
+        if (fresh || orders_.trimming()) {
+            bytes += orders_.trim(keep_free, max_slots);
+        }
+    }
+    return bytes;
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+bool OrderBook<Notification, Levels, MarketData, Stats, Index>::trimming() const {
+    if constexpr (requires { orders_.trimming(); }) {
+        if (orders_.trimming()) {
+            return true;
+        }
+    }
+    return order_pool_.trimming();
+}
+
+template <class Notification, template <PriceType> class Levels, class MarketData, class Stats, class Index>
+std::string OrderBook<Notification, Levels, MarketData, Stats, Index>::toString() {
     std::stringstream ss;
 
     // Best-first traversal of each side: bids high->low, asks low->high.
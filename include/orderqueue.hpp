@@ -22,12 +22,19 @@ class OrderQueue : public boost::intrusive::set_base_hook<boost::intrusive::opti
     Decimal total_qty_;
 
    public:
+    static constexpr uint32_t kNoPositions = UINT32_MAX;
+
+    // Slot of this queue's tree in the book's QueuePositions; only the L3 feed
+    // sets it.
+    uint32_t positions_slot = kNoPositions;
+
     OrderQueue(const Decimal &price) : price_(price){};
     [[nodiscard]] Decimal price() const;
-    uint64_t len();
+    [[nodiscard]] uint64_t len() const;
     [[nodiscard]] Decimal totalQty() const;
     void append(Order *o);
     void remove(Order *o);
+    void reduce(Order *o, Decimal qty);
     Decimal process(const TradeNotification &tn, const PostOrderFill &postFill, OrderID takerOrderID, Decimal qty);
     [[nodiscard]] const OrderList &order_list() const { return orders_; }
 
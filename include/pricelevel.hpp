@@ -38,11 +38,19 @@ class PriceLevel {
     uint64_t depth();
     Decimal volume();
     [[nodiscard]] OrderQueue* getQueue();
+    [[nodiscard]] OrderQueue* find(const Decimal& price) { return store_.find(price); }
     [[nodiscard]] OrderQueue* largestLessThan(const Decimal& price);
     [[nodiscard]] OrderQueue* smallestGreaterThan(const Decimal& price);
 
     void append(Order* order);
     void remove(Order* order);
+    void reduce(Order* order, Decimal qty);
+    void requeue(Order* order, Decimal qty);
+
+    [[nodiscard]] const Store& store() const { return store_; }
+
+    void prefetchSlot(const Decimal& price) const { store_.prefetchSlot(price); }
+    void prefetchQueue(const Decimal& price) const { store_.prefetchQueue(price); }
 
     template <PriceType Q = P>
     [[nodiscard]] OrderQueue* getNextQueue(const Decimal& price);
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "order.hpp"
+#include "orderqueue.hpp"
+
+namespace orderbook {
+
+// FIFO positions of resting orders for the L3 feed, in O(log depth) per event
+// instead of a walk from the front of the queue.
+//
+// Each queue the feed has seen owns a Fenwick tree over tickets: an order takes
+// the next ticket of its queue when appended and its slot counts 1 while it
+// rests, so its position is the number of live tickets before its own. Tickets
+// are reissued front to back in one pass when a queue runs out of them, with
+// room for twice its depth, so that is amortised O(1) per append. A queue found
+// holding orders the tracker was not told about (a loaded snapshot) is renumbered
+// the same way. Trees of emptied queues are kept for reuse, so steady state
+// allocates nothing. Tickets are kept per order-pool handle, outside Order, so
+// every call takes the pool the orders live in.
+class QueuePositions {
+    struct Fifo {
+        std::vector<int32_t> tree;
+        uint32_t next = 0;
+        uint32_t live = 0;
+    };
+
+    std::vector<Fifo> fifos_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> tickets_;
+
+    static constexpr size_t kMinTickets = 16;
+
+   public:
+    // Position of an order that was just appended to the back of q.
+    template <class Pool>
+    uint64_t append(const Pool& pool, OrderQueue* q, const Order* order) {
+        Fifo& f = fifo(q);
+        if (f.live + 1 != q->len() || f.next == f.tree.size()) {
+            renumber(pool, q, f);
+            return f.live - 1;
+        }
+        const uint32_t t = f.next++;
+        ticket(pool, order) = t;
+        add(f, t, 1);
+        return f.live++;
+    }
+
+    // Position of an order resting in q.
+    template <class Pool>
+    uint64_t position(const Pool& pool, OrderQueue* q, const Order* order) {
+        Fifo& f = sync(pool, q);
+        return static_cast<uint64_t>(prefix(f, ticket(pool, order)) - 1);
+    }
+
+    // An order about to be taken off q. The last one hands the queue's tree
+    // back for reuse, as the queue itself is released with it.
+    template <class Pool>
+    void leave(const Pool& pool, OrderQueue* q, const Order* order) {
+        Fifo& f = sync(pool, q);
+        add(f, ticket(pool, order), -1);
+        if (--f.live == 0) {
+            f.next = 0;
+            free_.push_back(q->positions_slot);
+            q->positions_slot = OrderQueue::kNoPositions;
+        }
+    }
+
+   private:
+    Fifo& fifo(OrderQueue* q) {
+        if (q->positions_slot == OrderQueue::kNoPositions) {
+            if (free_.empty()) {
+                free_.push_back(static_cast<uint32_t>(fifos_.size()));
+                fifos_.emplace_back();
+            }
+            q->positions_slot = free_.back();
+            free_.pop_back();
+        }
+        return fifos_[q->positions_slot];
+    }
+
+    template <class Pool>
+    Fifo& sync(const Pool& pool, OrderQueue* q) {
+        Fifo& f = fifo(q);
+        if (f.live != q->len()) [[unlikely]] {
+            renumber(pool, q, f);
+        }
+        return f;
+    }
+
+    template <class Pool>
+    uint32_t& ticket(const Pool& pool, const Order* order) {
+        const size_t h = pool.handle(order);
+        if (h >= tickets_.size()) [[unlikely]] {
+            tickets_.resize(std::max(h + 1, tickets_.size() * 2));
+        }
+        return tickets_[h];
+    }
+
+    // Reissue tickets 0..len-1 front to back and build the tree over them in
+    // O(len).
+    template <class Pool>
+    void renumber(const Pool& pool, OrderQueue* q, Fifo& f) {
+        const auto n = static_cast<uint32_t>(q->len());
+        f.tree.assign(std::bit_ceil(std::max<size_t>(kMinTickets, size_t{n} * 2)), 0);
+        uint32_t t = 0;
+        for (const auto& order : q->order_list()) {
+            ticket(pool, &order) = t;
+            f.tree[t++] = 1;
+        }
+        for (size_t i = 0; i < f.tree.size(); ++i) {
+            if (const size_t j = i | (i + 1); j < f.tree.size()) {
+                f.tree[j] += f.tree[i];
+            }
+        }
+        f.next = f.live = n;
+    }
+
+    static void add(Fifo& f, size_t i, int32_t delta) {
+        for (; i < f.tree.size(); i |= i + 1) {
+            f.tree[i] += delta;
+        }
+    }
+
+    // Live tickets in [0, i].
+    static int64_t prefix(const Fifo& f, size_t i) {
+        int64_t sum = 0;
+        for (size_t j = i + 1; j > 0; j &= j - 1) {
+            sum += f.tree[j - 1];
+        }
+        return sum;
+    }
+};
+
+struct NoQueuePositions {};
+
+}  // namespace orderbook
@@ -52,8 +52,10 @@ class RbTreeLevels {
     };
 
    public:
-    explicit RbTreeLevels(const LevelStoreConfig& cfg) : queue_pool_(cfg.pool_size) {}
+    explicit RbTreeLevels(const LevelStoreConfig& cfg) : queue_pool_(cfg.pool_size, cfg.pool_slabs) {}
 
+    // O(1): boost::intrusive keeps the leftmost node cached in the tree header,
+    // so begin() is the best level without a walk.
     [[nodiscard]] OrderQueue* best() {
         auto it = price_tree_.begin();
         if (it != price_tree_.end()) {
@@ -73,6 +75,14 @@ class RbTreeLevels {
         return &*it;
     }
 
+    [[nodiscard]] OrderQueue* find(const Decimal& price) {
+        auto it = price_tree_.find(price);
+        if (it == price_tree_.end()) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
     void erase(OrderQueue* q) {
         price_tree_.erase(price_tree_.iterator_to(*q));
         --depth_;
@@ -123,7 +133,16 @@ class RbTreeLevels {
         }
     }
 
+    // Any price can have a level; the tree has no tick grid.
+    [[nodiscard]] bool onGrid(const Decimal&) const { return true; }
     [[nodiscard]] uint64_t depth() const { return depth_; }
+    [[nodiscard]] uint64_t grows() const { return 0; }  // a tree never reallocates
+    [[nodiscard]] size_t slabs() const { return queue_pool_.slabs(); }
+
+    // Prefetch hooks (see LevelStore): a tree has no O(1) address for a price
+    // without walking it, so these are no-ops.
+    void prefetchSlot(const Decimal&) const {}
+    void prefetchQueue(const Decimal&) const {}
 };
 
 }  // namespace orderbook
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+#include "types.hpp"
+
+namespace orderbook {
+namespace snapshot {
+
+// Binary book snapshot, written by OrderBook::saveSnapshot and read back by
+// OrderBook::loadSnapshot. All integers are fixed-width and in host byte order
+// (snapshots are for restarting the same deployment, not for interchange);
+// Decimals are stored as their raw fixed-point value.
+//
+//   Header   magic u32, version u16, matching u8, reserved u8,
+//            base_fp u64, tick_fp u64, last_price u64, order_count u64
+//   Side x2  bids then asks, each best level first:
+//              level_count u64
+//              Level  price u64, orders u64, then per order in FIFO order:
+//                     id u64, qty u64, original_qty u64, type u8, flag u8
+//
+// Bump kVersion on any layout change; loadSnapshot rejects other versions.
+inline constexpr uint32_t kMagic = 0x4F42534E;  // "OBSN"
+inline constexpr uint16_t kVersion = 1;
+
+struct Header {
+    uint32_t magic = kMagic;
+    uint16_t version = kVersion;
+    uint8_t matching = 1;
+    uint8_t reserved = 0;
+    uint64_t base_fp = 0;
+    uint64_t tick_fp = 0;
+    uint64_t last_price = 0;
+    uint64_t order_count = 0;
+};
+
+// One resting order as read from a snapshot, before it is placed in the book.
+struct OrderRecord {
+    OrderID id;
+    Decimal qty;
+    Decimal original_qty;
+    Decimal price;
+    Type type;
+    Flag flag;
+    Side side;
+};
+
+template <class T>
+void put(std::ostream& os, T v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <class T>
+bool get(std::istream& is, T& v) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&v), sizeof(v)));
+}
+
+inline void putDecimal(std::ostream& os, const Decimal& d) { put<uint64_t>(os, d.fp); }
+
+inline bool getDecimal(std::istream& is, Decimal& d) {
+    uint64_t fp;
+    if (!get(is, fp)) {
+        return false;
+    }
+    d = decimalFromFp(fp);
+    return true;
+}
+
+inline void putHeader(std::ostream& os, const Header& h) {
+    put(os, h.magic);
+    put(os, h.version);
+    put(os, h.matching);
+    put(os, h.reserved);
+    put(os, h.base_fp);
+    put(os, h.tick_fp);
+    put(os, h.last_price);
+    put(os, h.order_count);
+}
+
+inline bool getHeader(std::istream& is, Header& h) {
+    return get(is, h.magic) && get(is, h.version) && get(is, h.matching) && get(is, h.reserved) && get(is, h.base_fp) && get(is, h.tick_fp) &&
+           get(is, h.last_price) && get(is, h.order_count);
+}
+
+}  // namespace snapshot
+}  // namespace orderbook
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace orderbook {
+
+inline constexpr size_t kCacheLine = 64;
+
+// Bounded lock-free single-producer / single-consumer ring.
+//
+// Capacity is rounded up to a power of two so a slot is index & mask. tail_ is
+// written only by the producer and head_ only by the consumer; each sits on its
+// own cache line next to that side's cached copy of the other index, so the
+// common case touches only the caller's own line and re-reads the shared index
+// only when the cached copy says full / empty. Slots are default-constructed up
+// front and assigned in place: push and pop never allocate.
+template <class T>
+class SpscRing {
+   public:
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_ = std::make_unique<T[]>(cap);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    [[nodiscard]] size_t capacity() const { return mask_ + 1; }
+
+    // Producer side. false when the ring is full; nothing is written.
+    bool tryPush(const T& v) {
+        const uint64_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.head_cache > mask_) {
+            producer_.head_cache = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.head_cache > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = v;
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. false when the ring is empty.
+    bool tryPop(T& out) {
+        const uint64_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.tail_cache) {
+            consumer_.tail_cache = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.tail_cache) {
+                return false;
+            }
+        }
+        out = slots_[head & mask_];
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Hands up to max available items to f in FIFO order and
+    // releases their slots with a single store; returns how many were consumed.
+    template <class F>
+    size_t consume(size_t max, F&& f) {
+        const uint64_t head = consumer_.head.load(std::memory_order_relaxed);
+        consumer_.tail_cache = producer_.tail.load(std::memory_order_acquire);
+        size_t n = static_cast<size_t>(consumer_.tail_cache - head);
+        if (n > max) {
+            n = max;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            f(slots_[(head + i) & mask_]);
+        }
+        if (n != 0) {
+            consumer_.head.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Either side; a snapshot that may be stale by the time it is used.
+    [[nodiscard]] bool empty() const {
+        return consumer_.head.load(std::memory_order_acquire) == producer_.tail.load(std::memory_order_acquire);
+    }
+
+   private:
+    struct alignas(kCacheLine) Producer {
+        std::atomic<uint64_t> tail{0};
+        uint64_t head_cache = 0;
+    };
+
+    struct alignas(kCacheLine) Consumer {
+        std::atomic<uint64_t> head{0};
+        uint64_t tail_cache = 0;
+    };
+
+    Producer producer_;
+    Consumer consumer_;
+    size_t mask_ = 0;
+    std::unique_ptr<T[]> slots_;
+};
+
+}  // namespace orderbook
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "types.hpp"
+
+namespace orderbook {
+
+inline constexpr size_t kErrorCount = static_cast<size_t>(Error::NoMatching) + 1;
+
+// Plain copy of a book's counters, as returned by OrderBook::stats().
+//
+// The structural counters at the bottom only move on cold paths (a tick array
+// or bucket array reallocating, a pool taking a new slab) and are always
+// maintained. Everything else is counted on the hot path and stays zero unless
+// the book is built with the CountingStats policy.
+struct BookStats {
+    static constexpr size_t kBuckets = 8;
+
+    uint64_t adds = 0;      // orders accepted by addOrder
+    uint64_t cancels = 0;   // successful cancels
+    uint64_t modifies = 0;  // accepted amends
+    uint64_t trades = 0;    // fills, one per maker order touched
+    std::array<uint64_t, kErrorCount> rejects{};  // indexed by Error
+
+    // Aggressive orders (adds, and amends that cross) that traded, by the number
+    // of price levels they traded at: levels_swept[n - 1] counts n levels, the
+    // last bucket kBuckets or more.
+    std::array<uint64_t, kBuckets> levels_swept{};
+    // OrderQueue::process calls, by the number of resting orders each filled
+    // against, bucketed the same way.
+    std::array<uint64_t, kBuckets> orders_per_process{};
+
+    uint64_t live_orders = 0;
+    uint64_t peak_live_orders = 0;
+
+    uint64_t level_grows = 0;       // ArrayLevels tick-array reallocations, both sides
+    uint64_t index_rehashes = 0;    // FibHashIndex bucket-array rehashes
+    uint64_t order_pool_slabs = 0;  // slabs allocated by each ObjectPool,
+    uint64_t index_pool_slabs = 0;  // initial ones included
+    uint64_t level_pool_slabs = 0;
+};
+
+// Stats policy (compile-time, no virtual dispatch). OrderBook owns one instance
+// and calls the hooks below from its own thread; NoStats makes every hook an
+// empty inline function, so a book without stats compiles to the same code as
+// before. A policy fills the hot-path fields of BookStats in snapshot().
+struct NoStats {
+    void onAdd() {}
+    void onCancel() {}
+    void onModify() {}
+    void onReject(Error) {}
+    void beginSweep() {}
+    void onFill(const Decimal&) {}
+    void endSweep() {}
+    void onLiveOrders(size_t) {}
+    void snapshot(BookStats&) const {}
+};
+
+// Counts every hook. The book's thread is the only writer, so each counter is
+// bumped with a relaxed load and store (no locked instruction), and any thread
+// may call OrderBook::stats() and read a consistent value of every field.
+class CountingStats {
+   public:
+    void onAdd() { bump(adds_); }
+    void onCancel() { bump(cancels_); }
+    void onModify() { bump(modifies_); }
+    void onReject(Error e) { bump(rejects_[static_cast<size_t>(e)]); }
+
+    // One aggressive order: beginSweep, one onFill per fill in the order the
+    // book matched them, endSweep. Fills at one price come from one
+    // OrderQueue::process call.
+    void beginSweep() {
+        levels_ = 0;
+        level_fills_ = 0;
+    }
+
+    void onFill(const Decimal& price) {
+        bump(trades_);
+        if (level_fills_ == 0 || price != level_price_) {
+            closeLevel();
+            ++levels_;
+            level_price_ = price;
+        }
+        ++level_fills_;
+    }
+
+    void endSweep() {
+        if (levels_ == 0) {
+            return;
+        }
+        closeLevel();
+        bump(levels_swept_[bucket(levels_)]);
+    }
+
+    void onLiveOrders(size_t live) {
+        live_.store(live, std::memory_order_relaxed);
+        if (live > peak_.load(std::memory_order_relaxed)) {
+            peak_.store(live, std::memory_order_relaxed);
+        }
+    }
+
+    void snapshot(BookStats& s) const {
+        s.adds = adds_.load(std::memory_order_relaxed);
+        s.cancels = cancels_.load(std::memory_order_relaxed);
+        s.modifies = modifies_.load(std::memory_order_relaxed);
+        s.trades = trades_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kErrorCount; ++i) {
+            s.rejects[i] = rejects_[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < BookStats::kBuckets; ++i) {
+            s.levels_swept[i] = levels_swept_[i].load(std::memory_order_relaxed);
+            s.orders_per_process[i] = orders_per_process_[i].load(std::memory_order_relaxed);
+        }
+        s.live_orders = live_.load(std::memory_order_relaxed);
+        s.peak_live_orders = peak_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    using Counter = std::atomic<uint64_t>;
+
+    static void bump(Counter& c) { c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    static size_t bucket(uint64_t n) { return n < BookStats::kBuckets ? static_cast<size_t>(n - 1) : BookStats::kBuckets - 1; }
+
+    void closeLevel() {
+        if (level_fills_ != 0) {
+            bump(orders_per_process_[bucket(level_fills_)]);
+            level_fills_ = 0;
+        }
+    }
+
+    Counter adds_{0};
+    Counter cancels_{0};
+    Counter modifies_{0};
+    Counter trades_{0};
+    std::array<Counter, kErrorCount> rejects_{};
+    std::array<Counter, BookStats::kBuckets> levels_swept_{};
+    std::array<Counter, BookStats::kBuckets> orders_per_process_{};
+    Counter live_{0};
+    Counter peak_{0};
+
+    // Current sweep; only ever touched by the book's thread.
+    uint64_t levels_ = 0;
+    uint64_t level_fills_ = 0;
+    Decimal level_price_{};
+};
+
+}  // namespace orderbook
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "object_pool.hpp"
+#include "order.hpp"
+#include "types.hpp"
+
+namespace orderbook {
+namespace index {
+
+// Open-addressing OrderID -> Order* map in the Swiss-table layout, a drop-in
+// alternative to FibHashIndex (same interface, selected through OrderBook's
+// Index parameter). {id, Order*} pairs sit inline in a slot array, so a hit is
+// one control-byte group plus one slot instead of bucket -> node. Slots are
+// grouped by 16; each has a control byte that is kEmpty, kDeleted, or the top
+// 7 bits of the id's hash. A lookup hashes to a group, compares all 16 control
+// bytes against the tag with one SSE2 compare, checks the few candidate slots,
+// and stops at the first group that still has an empty slot; groups are probed
+// triangularly, which visits every group of a power-of-two table.
+//
+// Load is capped at 7/8 counting tombstones. When that is reached the table
+// either doubles or, if most of the load is tombstones, rehashes in place.
+// Like FibHashIndex, a rehash rebuilds the whole table at once.
+class SwissIndex {
+   public:
+    static constexpr uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
+    static constexpr size_t kGroupSize = 16;
+
+    using OrderPool = pool::ObjectPool<Order>;
+
+    explicit SwissIndex(size_t reserve_entries = 1u << 16) { setGroups(groupsFor(reserve_entries)); }
+
+    // Form OrderBook uses for every index policy; the pool is not needed.
+    SwissIndex(const OrderPool&, size_t reserve_entries) : SwissIndex(reserve_entries) {}
+
+    SwissIndex(const SwissIndex&) = delete;
+    SwissIndex& operator=(const SwissIndex&) = delete;
+
+    Order* find(uint64_t id) const {
+        const size_t i = locate(id);
+        return i == kNotFound ? nullptr : slots_[i].val;
+    }
+
+    bool contains(uint64_t id) const { return find(id) != nullptr; }
+
+    size_t size() const { return size_; }
+
+    // Cold-path counters, as FibHashIndex: table rebuilds (growth or tombstone
+    // cleanup) so far. There is no node pool, so slabs() is always 0.
+    uint64_t rehashes() const { return rehashes_.load(std::memory_order_relaxed); }
+    size_t slabs() const { return 0; }
+
+    // Grow once so that n entries fit without a rehash. Never shrinks.
+    void reserve(size_t n) {
+        const size_t groups = groupsFor(n);
+        if (groups > groups_) rehash(groups);
+    }
+
+    // Prefetch hooks with FibHashIndex's contract. prefetchBucket pulls id's
+    // first control group; prefetchNode, issued once that group should be
+    // cached, pulls the first slot whose tag matches (or the group's first
+    // slot). Neither reads a slot.
+    void prefetchBucket(uint64_t id) const { __builtin_prefetch(&ctrl_[groupOf(hash(id)) * kGroupSize]); }
+
+    void prefetchNode(uint64_t id) const {
+        const uint64_t h = hash(id);
+        const size_t base = groupOf(h) * kGroupSize;
+        const uint32_t m = Group(&ctrl_[base]).match(tagOf(h));
+        __builtin_prefetch(&slots_[base + (m != 0 ? static_cast<size_t>(std::countr_zero(m)) : 0)]);
+    }
+
+    void insert(uint64_t id, Order* o) {
+        // Caller must dedup (contains()) first; insert never overwrites a live id.
+        assert(find(id) == nullptr && "SwissIndex::insert on existing id");
+        const uint64_t h = hash(id);
+        size_t i = freeSlot(h);
+        if (growth_left_ == 0 && ctrl_[i] == kEmpty) {
+            // Mostly tombstones: clean up in place; otherwise double.
+            rehash(size_ <= capacity() * 7 / 16 ? groups_ : groups_ * 2);
+            i = freeSlot(h);
+        }
+        if (ctrl_[i] == kEmpty) --growth_left_;
+        ctrl_[i] = tagOf(h);
+        slots_[i] = {id, o};
+        ++size_;
+    }
+
+    // Remove id and return its Order* (nullptr if absent). A slot whose group
+    // still has an empty slot becomes empty again: no probe ever continued past
+    // that group. Otherwise it becomes a tombstone.
+    Order* erase(uint64_t id) {
+        const size_t i = locate(id);
+        if (i == kNotFound) return nullptr;
+        if (Group(&ctrl_[i & ~(kGroupSize - 1)]).matchEmpty() != 0) {
+            ctrl_[i] = kEmpty;
+            ++growth_left_;
+        } else {
+            ctrl_[i] = kDeleted;
+        }
+        --size_;
+        return slots_[i].val;
+    }
+
+   private:
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+    static constexpr size_t kNotFound = SIZE_MAX;
+
+    struct Slot {
+        uint64_t key;
+        Order* val;
+    };
+
+    // 16 control bytes compared at once; bit i of a mask is slot i.
+    struct Group {
+#if defined(__SSE2__)
+        __m128i ctrl;
+
+        explicit Group(const int8_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+        uint32_t match(int8_t tag) const { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl))); }
+        // Empty and deleted are the only negative control bytes.
+        uint32_t matchEmptyOrDeleted() const { return static_cast<uint32_t>(_mm_movemask_epi8(ctrl)); }
+#else
+        const int8_t* ctrl;
+
+        explicit Group(const int8_t* p) : ctrl(p) {}
+
+        uint32_t match(int8_t tag) const {
+            uint32_t m = 0;
+            for (size_t i = 0; i < kGroupSize; ++i) m |= uint32_t{ctrl[i] == tag} << i;
+            return m;
+        }
+        uint32_t matchEmptyOrDeleted() const {
+            uint32_t m = 0;
+            for (size_t i = 0; i < kGroupSize; ++i) m |= uint32_t{ctrl[i] < 0} << i;
+            return m;
+        }
+#endif
+        uint32_t matchEmpty() const { return match(kEmpty); }
+    };
+
+    static uint64_t hash(uint64_t id) { return id * GOLDEN; }
+    // Top 7 bits of the product tag the slot; the bits below them pick the group.
+    static int8_t tagOf(uint64_t h) { return static_cast<int8_t>(h >> 57); }
+    size_t groupOf(uint64_t h) const { return static_cast<size_t>(h >> group_shift_) & group_mask_; }
+    size_t capacity() const { return groups_ * kGroupSize; }
+
+    // Smallest power-of-two group count holding n entries at load <= 7/8.
+    static size_t groupsFor(size_t n) {
+        size_t groups = 1;
+        while (groups * kGroupSize * 7 / 8 < n) groups <<= 1;
+        return groups;
+    }
+
+    size_t locate(uint64_t id) const {
+        const uint64_t h = hash(id);
+        const int8_t tag = tagOf(h);
+        size_t g = groupOf(h);
+        for (size_t step = 1;; ++step) {
+            const size_t base = g * kGroupSize;
+            const Group group(&ctrl_[base]);
+            for (uint32_t m = group.match(tag); m != 0; m &= m - 1) {
+                const size_t i = base + static_cast<size_t>(std::countr_zero(m));
+                if (slots_[i].key == id) return i;
+            }
+            if (group.matchEmpty() != 0) return kNotFound;
+            g = (g + step) & group_mask_;
+        }
+    }
+
+    // First empty or deleted slot on h's probe sequence; the load cap keeps
+    // at least one empty slot in the table, so this always finds one.
+    size_t freeSlot(uint64_t h) const {
+        size_t g = groupOf(h);
+        for (size_t step = 1;; ++step) {
+            const size_t base = g * kGroupSize;
+            if (const uint32_t m = Group(&ctrl_[base]).matchEmptyOrDeleted(); m != 0) {
+                return base + static_cast<size_t>(std::countr_zero(m));
+            }
+            g = (g + step) & group_mask_;
+        }
+    }
+
+    void setGroups(size_t groups) {
+        groups_ = groups;
+        group_mask_ = groups - 1;
+        group_shift_ = 57u - static_cast<unsigned>(std::countr_zero(groups));
+        ctrl_.assign(capacity(), kEmpty);
+        slots_.assign(capacity(), Slot{});
+        growth_left_ = capacity() * 7 / 8;
+    }
+
+    // Rebuild at new_groups, dropping tombstones.
+    void rehash(size_t new_groups) {
+        rehashes_.store(rehashes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::vector<int8_t> old_ctrl = std::move(ctrl_);
+        std::vector<Slot> old_slots = std::move(slots_);
+        setGroups(new_groups);
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+            if (old_ctrl[i] >= 0) {
+                const uint64_t h = hash(old_slots[i].key);
+                const size_t j = freeSlot(h);
+                ctrl_[j] = tagOf(h);
+                slots_[j] = old_slots[i];
+                --growth_left_;
+            }
+        }
+    }
+
+    std::vector<int8_t> ctrl_;
+    std::vector<Slot> slots_;
+    size_t groups_ = 0;
+    size_t group_mask_ = 0;
+    unsigned group_shift_ = 0;
+    size_t size_ = 0;
+    size_t growth_left_ = 0;
+    std::atomic<uint64_t> rehashes_{0};
+};
+
+}  // namespace index
+}  // namespace orderbook
@@ -12,6 +12,14 @@ namespace orderbook {
 using Decimal = decimal::U8;
 using OrderID = uint64_t;
 
+// Decimal whose raw fixed-point value is fp (the inverse of reading d.fp), for
+// the binary snapshot and journal formats.
+inline Decimal decimalFromFp(uint64_t fp) {
+    Decimal d{};
+    d.fp = fp;
+    return d;
+}
+
 enum class Type : uint8_t {
     Limit,
     Market,
@@ -28,7 +36,8 @@ std::ostream& operator<<(std::ostream& os, const Side& side);
 
 enum class MsgType : uint8_t {
     CreateOrder,
-    CancelOrder
+    CancelOrder,
+    ModifyOrder,
 };
 
 std::ostream& operator<<(std::ostream& os, const MsgType& msgType);
@@ -77,6 +86,7 @@ enum class ExecType : uint8_t {
     Rejected,
     Canceled,
     Trade,
+    Replaced,
 };
 
 std::ostream& operator<<(std::ostream& os, const ExecType& execType);
@@ -84,7 +94,7 @@ std::ostream& operator<<(std::ostream& os, const ExecType& execType);
 struct ExecutionReport {
     ExecType exec_type{};
 
-    // Order event fields (New, Rejected, Canceled)
+    // Order event fields (New, Rejected, Canceled, Replaced)
     MsgType msg_type{};
     OrderID order_id{};
     OrderStatus status{};
@@ -103,18 +113,168 @@ struct ExecutionReport {
     std::optional<Error> error{};
 };
 
-// Notification is the interface for actual implementation of a notification handler
+// Aggregate state of one price level as returned by the book queries. An empty
+// level (or empty side) is reported as orders == 0 with zero price and qty.
+struct LevelInfo {
+    Decimal price{};
+    Decimal qty{};
+    uint64_t orders = 0;
+
+    [[nodiscard]] bool empty() const { return orders == 0; }
+};
+
+enum class CommandType : uint8_t {
+    Add,
+    Cancel,
+    Modify,
+};
+
+std::ostream& operator<<(std::ostream& os, const CommandType& commandType);
+
+// Command is one inbound book instruction, as consumed by
+// OrderBook::processBatch. Cancel only reads id; Modify reads id, qty and price.
+struct Command {
+    CommandType kind{};
+    Type type{};
+    Side side{};
+    Flag flag{};
+    OrderID id{};
+    Decimal qty{};
+    Decimal price{};
+};
+
+// Handle to a resting order, returned by the with_handle overload of
+// OrderBook::addOrder and accepted by cancelOrder / modifyOrder / hasOrder in
+// place of the id. slot is the order's ObjectPool handle and generation tells
+// apart the orders that have held that slot, so the book checks a handle in
+// O(1) without the index; a handle whose order has left the book is rejected
+// like an unknown id. id is carried for reports. An order that did not rest
+// (filled, IoC, market, rejected) gets a null() handle.
+struct OrderHandle {
+    OrderID id{};
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    [[nodiscard]] bool null() const { return generation == 0; }
+};
+
+// Tag selecting the addOrder overload that returns an OrderHandle.
+struct WithHandle {
+    explicit WithHandle() = default;
+};
+inline constexpr WithHandle with_handle{};
+
+// Compact per-event reports. Each carries only the fields of its own event, so a
+// handler that overrides the matching NotificationInterface hook never builds or
+// copies the full ExecutionReport. All fit well inside a 64-byte slot.
+struct TradeReport {
+    OrderID maker_order_id{};
+    OrderID taker_order_id{};
+    Decimal qty{};
+    Decimal price{};
+    OrderStatus maker_status{};
+    OrderStatus taker_status{};
+};
+
+// New (Accepted), Canceled and Replaced order events.
+struct OrderReport {
+    OrderID order_id{};
+    Decimal qty{};
+    Decimal original_qty{};
+    MsgType msg_type{};
+};
+
+struct RejectReport {
+    OrderID order_id{};
+    Decimal qty{};
+    Decimal original_qty{};
+    MsgType msg_type{};
+    Error error{};
+};
+
+static_assert(sizeof(TradeReport) <= 64 && sizeof(OrderReport) <= 64 && sizeof(RejectReport) <= 64);
+
+// Notification is the interface for actual implementation of a notification handler.
+//
+// The book calls one hook per event: onNew, onCancel, onReplace, onReject and
+// onTrade. An implementation may override any of them with a handler taking the
+// compact report; hooks it does not override fall back to the defaults below,
+// which expand the event into an ExecutionReport and call onExecutionReport. A
+// handler that only implements onExecutionReport therefore sees exactly the
+// stream it always has.
 template <typename Implementation>
 class NotificationInterface {
    public:
     void onExecutionReport(const ExecutionReport& report) {
         static_cast<Implementation*>(this)->onExecutionReport(report);
     }
+
+    void onNew(const OrderReport& r) {
+        static_cast<Implementation*>(this)->onExecutionReport(ExecutionReport{
+            .exec_type = ExecType::New,
+            .msg_type = r.msg_type,
+            .order_id = r.order_id,
+            .status = OrderStatus::Accepted,
+            .qty = r.qty,
+            .original_qty = r.original_qty,
+        });
+    }
+
+    void onCancel(const OrderReport& r) {
+        static_cast<Implementation*>(this)->onExecutionReport(ExecutionReport{
+            .exec_type = ExecType::Canceled,
+            .msg_type = r.msg_type,
+            .order_id = r.order_id,
+            .status = OrderStatus::Canceled,
+            .qty = r.qty,
+            .original_qty = r.original_qty,
+        });
+    }
+
+    void onReplace(const OrderReport& r) {
+        static_cast<Implementation*>(this)->onExecutionReport(ExecutionReport{
+            .exec_type = ExecType::Replaced,
+            .msg_type = r.msg_type,
+            .order_id = r.order_id,
+            .status = OrderStatus::Accepted,
+            .qty = r.qty,
+            .original_qty = r.original_qty,
+        });
+    }
+
+    void onReject(const RejectReport& r) {
+        static_cast<Implementation*>(this)->onExecutionReport(ExecutionReport{
+            .exec_type = ExecType::Rejected,
+            .msg_type = r.msg_type,
+            .order_id = r.order_id,
+            .status = OrderStatus::Rejected,
+            .qty = r.qty,
+            .original_qty = r.original_qty,
+            .error = r.error,
+        });
+    }
+
+    void onTrade(const TradeReport& r) {
+        static_cast<Implementation*>(this)->onExecutionReport(ExecutionReport{
+            .exec_type = ExecType::Trade,
+            .maker_order_id = r.maker_order_id,
+            .taker_order_id = r.taker_order_id,
+            .maker_status = r.maker_status,
+            .taker_status = r.taker_status,
+            .last_qty = r.qty,
+            .last_price = r.price,
+        });
+    }
 };
 
 class EmptyNotification : public NotificationInterface<EmptyNotification> {
    public:
     void onExecutionReport(const ExecutionReport&) {}
+    void onNew(const OrderReport&) {}
+    void onCancel(const OrderReport&) {}
+    void onReplace(const OrderReport&) {}
+    void onReject(const RejectReport&) {}
+    void onTrade(const TradeReport&) {}
 };
 
 }  // namespace orderbook
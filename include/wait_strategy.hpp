@@ -0,0 +1,59 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cstdint>
+#include <thread>
+
+namespace orderbook {
+
+// What a polling thread does when it finds no work.
+//
+//   Spin   re-poll immediately; lowest wake-up latency, burns the core and
+//          its hyper-thread sibling.
+//   Pause  CPU pause hint between polls; near-spin latency, frees pipeline
+//          resources for a sibling hyper-thread and saves power.
+//   Yield  sched_yield between polls; gives the core away when others want
+//          it, at the cost of a syscall and a possible reschedule.
+enum class WaitStrategy : uint8_t {
+    Spin,
+    Pause,
+    Yield,
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+inline void idle(WaitStrategy wait) {
+    switch (wait) {
+        case WaitStrategy::Spin:
+            break;
+        case WaitStrategy::Pause:
+            cpuRelax();
+            break;
+        case WaitStrategy::Yield:
+            std::this_thread::yield();
+            break;
+    }
+}
+
+// Pin the calling thread to one CPU. cpu < 0 leaves the affinity untouched.
+// Returns false if the kernel refused (e.g. the CPU is offline or outside the
+// process's cpuset).
+inline bool pinCurrentThread(int cpu) {
+    if (cpu < 0) {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+}  // namespace orderbook
@@ -1,3 +1,5 @@
+#include <unistd.h>
+
 #include <algorithm>
 #include <chrono>
 #include <deque>
@@ -10,8 +12,10 @@
 #include <thread>
 #include <vector>
 
+#include "bench/latency.hpp"
 #include "include/orderbook.hpp"
 #include "include/types.hpp"
+#include "include/wait_strategy.hpp"
 
 using orderbook::Decimal;
 using orderbook::Flag;
@@ -37,7 +41,7 @@ std::tuple<orderbook::Decimal, orderbook::Decimal, orderbook::Decimal, orderbook
                                                                                                           const orderbook::Decimal &upperBound,
                                                                                                           const orderbook::Decimal &minSpread) {
     orderbook::Decimal bid = (lowerBound + upperBound) / orderbook::Decimal(2, 0);
-    orderbook::Decimal ask = bid - minSpread;
+    orderbook::Decimal ask = bid + minSpread;
     orderbook::Decimal bidQty(10, 0);
     orderbook::Decimal askQty(10, 0);
 
@@ -56,9 +60,95 @@ std::pair<orderbook::Decimal, orderbook::Decimal> getPrice(orderbook::Decimal bi
     return {bid, ask};
 }
 
-void latency(int64_t seed, int duration, int pd, orderbook::Decimal lowerBound, orderbook::Decimal upperBound, orderbook::Decimal minSpread, bool sched) {
-    std::cout << "Latency function running...\n";
-    // Implement the latency benchmark logic.
+// Per-operation tail latency. A quote pair walks through [lowerBound,
+// upperBound]: each iteration moves it by a random 0..pd ticks of minSpread,
+// rests a bid and an ask near it, cancels the oldest resting order once more
+// than `depth` are live, and every fourth iteration sends an IoC order that
+// crosses the spread. Each add, cancel and cross is timed on its own with the
+// TSC and recorded in a per-type histogram; the book sits on a minSpread tick
+// grid. -sched asks for SCHED_FIFO and -cpu pins the thread first.
+void latency(int64_t seed, int duration, int pd, int depth, orderbook::Decimal lowerBound, orderbook::Decimal upperBound, orderbook::Decimal minSpread,
+             bool sched, int cpu) {
+    orderbook::bench::prepareTimedThread(cpu, sched);
+
+    std::cout << "starting latency benchmark...\n";
+    orderbook::bench::TscClock clock;
+    orderbook::bench::LatencyHistogram addHist, cancelHist, crossHist;
+
+    auto n = orderbook::EmptyNotification();
+    auto ob = std::make_unique<orderbook::OrderBook<orderbook::EmptyNotification>>(n, 16384, 16384, 16384, /*base_fp=*/0ULL, /*tick_fp=*/minSpread.fp,
+                                                                                   /*num_ticks=*/(upperBound.fp / minSpread.fp) + 64);
+
+    auto [bid, ask, bidQty, askQty] = getInitialVars(lowerBound, upperBound, minSpread);
+    const orderbook::Decimal crossQty(1, 0);
+
+    std::default_random_engine generator(seed);
+    std::uniform_int_distribution<int> step(0, pd);
+    std::uniform_int_distribution<int> offset(0, 4);
+    std::bernoulli_distribution down(0.5);
+
+    uint64_t nextID = 0, iterations = 0;
+    std::deque<OrderID> live;  // ids of resting orders, oldest at front.
+
+    const auto timed = [&clock](orderbook::bench::LatencyHistogram &h, auto &&op) {
+        const uint64_t t0 = orderbook::bench::TscClock::start();
+        op();
+        const uint64_t t1 = orderbook::bench::TscClock::stop();
+        h.record(clock.toNanos(t1 - t0));
+    };
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(duration);
+    while (std::chrono::steady_clock::now() < end) {
+        // Walk the quotes, bouncing off the band edges.
+        const orderbook::Decimal diff = minSpread * orderbook::Decimal(step(generator), 0);
+        bool dec = down(generator);
+        if (dec && bid < lowerBound + diff + minSpread * orderbook::Decimal(8, 0)) {
+            dec = false;
+        } else if (!dec && ask + diff + minSpread * orderbook::Decimal(8, 0) > upperBound) {
+            dec = true;
+        }
+        std::tie(bid, ask) = getPrice(bid, ask, diff, dec);
+
+        const orderbook::Decimal bidPx = bid - minSpread * orderbook::Decimal(offset(generator), 0);
+        const orderbook::Decimal askPx = ask + minSpread * orderbook::Decimal(offset(generator), 0);
+        // A walk can leave resting orders on the wrong side of the new quotes;
+        // those adds would cross, so only time a rest when it cannot trade.
+        const auto bestAsk = ob->bestAsk();
+        const auto bestBid = ob->bestBid();
+        if (bestAsk.empty() || bidPx < bestAsk.price) {
+            const OrderID id = ++nextID;
+            timed(addHist, [&] { ob->addOrder(id, Type::Limit, Side::Buy, bidQty, bidPx, Flag::None); });
+            live.push_back(id);
+        }
+        if (bestBid.empty() || askPx > bestBid.price) {
+            const OrderID id = ++nextID;
+            timed(addHist, [&] { ob->addOrder(id, Type::Limit, Side::Sell, askQty, askPx, Flag::None); });
+            live.push_back(id);
+        }
+
+        if (iterations % 4 == 3) {
+            const auto target = ob->bestAsk();
+            if (!target.empty()) {
+                const OrderID id = ++nextID;
+                timed(crossHist, [&] { ob->addOrder(id, Type::Limit, Side::Buy, crossQty, target.price, orderbook::IoC); });
+            }
+        }
+
+        while (live.size() > static_cast<size_t>(depth)) {
+            const OrderID id = live.front();
+            live.pop_front();
+            if (ob->hasOrder(id)) {
+                timed(cancelHist, [&] { ob->cancelOrder(id); });
+                break;
+            }
+        }
+        ++iterations;
+    }
+
+    std::cout << "Iterations: " << iterations << "  TSC: " << std::fixed << std::setprecision(3) << clock.ticksPerNano() << " ticks/ns" << std::endl;
+    addHist.print(std::cout, "add");
+    cancelHist.print(std::cout, "cancel");
+    crossHist.print(std::cout, "cross");
 }
 
 void throughput(int64_t seed, int duration, int depth, orderbook::Decimal lowerBound, orderbook::Decimal upperBound, orderbook::Decimal minSpread) {
@@ -117,13 +207,14 @@ void throughput(int64_t seed, int duration, int depth, orderbook::Decimal lowerB
     std::cout << "Avg latency: " << nanosecPerOp << " ns/op" << std::endl;
 }
 
-void run(int64_t seed, int duration, int pd, int depth, const std::string &lb, const std::string &ub, const std::string &ms, const std::string &n, bool sched) {
+void run(int64_t seed, int duration, int pd, int depth, const std::string &lb, const std::string &ub, const std::string &ms, const std::string &n, bool sched,
+         int cpu) {
     orderbook::Decimal lowerBound(lb);
     orderbook::Decimal upperBound(ub);
     orderbook::Decimal minSpread(ms);
 
     if (n == "latency") {
-        latency(seed, duration, pd, lowerBound, upperBound, minSpread, sched);
+        latency(seed, duration, pd, depth, lowerBound, upperBound, minSpread, sched, cpu);
     } else if (n == "throughput") {
         throughput(seed, duration, depth, lowerBound, upperBound, minSpread);
     }
@@ -138,10 +229,11 @@ int main(int argc, char *argv[]) {
     int pd = std::stoi(getCmdOption(argv, argv + argc, "-p", "10"));
     int depth = std::stoi(getCmdOption(argv, argv + argc, "-depth", "50000"));
     bool sched = cmdOptionExists(argv, argv + argc, "-sched");
+    int cpu = std::stoi(getCmdOption(argv, argv + argc, "-cpu", "-1"));
     std::string n = getCmdOption(argv, argv + argc, "-n", "latency");
 
     std::cout << "PID: " << getpid() << std::endl;
-    run(seed, duration, pd, depth, lb, ub, ms, n, sched);
+    run(seed, duration, pd, depth, lb, ub, ms, n, sched, cpu);
     return 0;
 }
 
@@ -0,0 +1,304 @@
+#include "journal.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace orderbook {
+namespace journal {
+
+namespace {
+
+bool writeAll(int fd, const void* buf, size_t len, off_t off) {
+    const auto* p = static_cast<const char*>(buf);
+    while (len > 0) {
+        const ssize_t n = ::pwrite(fd, p, len, off);
+        if (n < 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+        off += n;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* buf, size_t len, off_t off) {
+    auto* p = static_cast<char*>(buf);
+    while (len > 0) {
+        const ssize_t n = ::pread(fd, p, len, off);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+        off += n;
+    }
+    return true;
+}
+
+bool validHeader(const FileHeader& h) { return h.magic == kMagic && h.version == kVersion && h.record_size == sizeof(Record); }
+
+off_t slotOffset(uint64_t seq) { return static_cast<off_t>(sizeof(FileHeader) + (seq - 1) * sizeof(Record)); }
+
+// Records valid from first_seq on, i.e. the length of the prefix of slots whose
+// seqs run first_seq, first_seq + 1, ... with good checksums.
+size_t validFrom(std::span<const Record> slots, uint64_t first_seq) {
+    size_t n = 0;
+    while (n < slots.size() && slots[n].seq == first_seq + n && slots[n].check == checksum(slots[n])) {
+        ++n;
+    }
+    return n;
+}
+
+// Zero every slot from first_seq to the end of the file that is not zero yet.
+// Slots past the valid prefix can still hold records from before a crash with
+// matching seqs and checksums; once new records overwrite part of that tail,
+// the rest would read as their continuation.
+bool clearFrom(int fd, uint64_t first_seq, uint64_t capacity) {
+    std::vector<Record> chunk(4096);
+    const std::vector<Record> zeros(chunk.size(), Record{});
+    for (uint64_t seq = first_seq; seq <= capacity;) {
+        const size_t want = std::min<uint64_t>(chunk.size(), capacity - seq + 1);
+        const size_t bytes = want * sizeof(Record);
+        if (!readAll(fd, chunk.data(), bytes, slotOffset(seq))) {
+            return false;
+        }
+        if (std::memcmp(chunk.data(), zeros.data(), bytes) != 0 && !writeAll(fd, zeros.data(), bytes, slotOffset(seq))) {
+            return false;
+        }
+        seq += want;
+    }
+    return ::fdatasync(fd) == 0;
+}
+
+}  // namespace
+
+uint32_t checksum(const Record& r) {
+    // FNV-1a over every byte before the checksum itself.
+    const auto* p = reinterpret_cast<const unsigned char*>(&r);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(Record, check); ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+Record encode(uint64_t seq, const Command& cmd) {
+    Record r{
+        .seq = seq,
+        .id = cmd.id,
+        .qty = cmd.qty.fp,
+        .price = cmd.price.fp,
+        .kind = static_cast<uint8_t>(cmd.kind),
+        .type = static_cast<uint8_t>(cmd.type),
+        .side = static_cast<uint8_t>(cmd.side),
+        .flag = static_cast<uint8_t>(cmd.flag),
+        .check = 0,
+    };
+    r.check = checksum(r);
+    return r;
+}
+
+Command decode(const Record& r) {
+    return {
+        .kind = static_cast<CommandType>(r.kind),
+        .type = static_cast<Type>(r.type),
+        .side = static_cast<Side>(r.side),
+        .flag = static_cast<Flag>(r.flag),
+        .id = r.id,
+        .qty = decimalFromFp(r.qty),
+        .price = decimalFromFp(r.price),
+    };
+}
+
+size_t validPrefix(std::span<const Record> slots) { return validFrom(slots, 1); }
+
+Journal::Journal(const std::string& path, const JournalConfig& cfg) : cfg_(cfg), ring_(cfg.ring_capacity) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return;
+    }
+
+    FileHeader header;
+    if (st.st_size == 0) {
+        // New journal: write the header and reserve every slot now so appends
+        // never extend the file (no metadata update per group commit).
+        header.record_size = sizeof(Record);
+        header.capacity = cfg_.capacity_records;
+        if (!writeAll(fd, &header, sizeof(header), 0) || ::posix_fallocate(fd, 0, slotOffset(header.capacity + 1)) != 0 || ::fsync(fd) != 0) {
+            ::close(fd);
+            return;
+        }
+    } else {
+        // Existing journal: continue after its last valid record.
+        if (!readAll(fd, &header, sizeof(header), 0) || !validHeader(header)) {
+            ::close(fd);
+            return;
+        }
+        cfg_.capacity_records = header.capacity;
+
+        std::vector<Record> chunk(4096);
+        uint64_t valid = 0;
+        while (valid < header.capacity) {
+            const size_t want = std::min<uint64_t>(chunk.size(), header.capacity - valid);
+            if (!readAll(fd, chunk.data(), want * sizeof(Record), slotOffset(valid + 1))) {
+                break;
+            }
+            const size_t n = validFrom(std::span<const Record>(chunk.data(), want), valid + 1);
+            valid += n;
+            if (n < want) {
+                break;
+            }
+        }
+        if (!clearFrom(fd, valid + 1, header.capacity)) {
+            ::close(fd);
+            return;
+        }
+        next_seq_ = valid + 1;
+        durable_seq_.store(valid, std::memory_order_relaxed);
+    }
+
+    fd_ = fd;
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&Journal::run, this);
+}
+
+Journal::~Journal() { close(); }
+
+bool Journal::tryAppend(const Command& cmd) {
+    if (fd_ < 0 || next_seq_ > cfg_.capacity_records) [[unlikely]] {
+        return false;
+    }
+    if (!ring_.tryPush(encode(next_seq_, cmd))) [[unlikely]] {
+        return false;
+    }
+    ++next_seq_;
+    return true;
+}
+
+void Journal::close() {
+    if (!writer_.joinable()) {
+        return;
+    }
+    running_.store(false, std::memory_order_release);
+    writer_.join();
+    ::close(fd_);
+    fd_ = -1;
+}
+
+// Writer thread: drain the ring in batches, write each batch with one pwrite and
+// fdatasync once sync_every_records are pending or the oldest pending record is
+// sync_interval old. A failed write or sync stops the writer; durableSeq() then
+// stops advancing and the ring fills, so tryAppend starts refusing commands.
+// An idle writer yields for a few rounds, then sleeps for doubling intervals up
+// to max_idle_sleep, so it costs next to no CPU without adding a wake-up to
+// tryAppend.
+void Journal::run() {
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t kMaxBatch = 256;
+    constexpr unsigned kYieldRounds = 64;
+
+    std::vector<Record> batch(kMaxBatch);
+    uint64_t written = durable_seq_.load(std::memory_order_relaxed);
+    uint64_t synced = written;
+    Clock::time_point oldest_pending;
+    unsigned idle = 0;
+    std::chrono::microseconds sleep{1};
+
+    for (;;) {
+        const bool stopping = !running_.load(std::memory_order_acquire);
+
+        size_t k = 0;
+        const size_t n = ring_.consume(kMaxBatch, [&](const Record& r) { batch[k++] = r; });
+        if (n != 0) {
+            if (!writeAll(fd_, batch.data(), n * sizeof(Record), slotOffset(batch[0].seq))) {
+                return;
+            }
+            if (written == synced) {
+                oldest_pending = Clock::now();
+            }
+            written = batch[n - 1].seq;
+        }
+
+        if (written != synced) {
+            const bool drained = n == 0 && stopping;
+            if (drained || written - synced >= cfg_.sync_every_records || Clock::now() - oldest_pending >= cfg_.sync_interval) {
+                if (::fdatasync(fd_) != 0) {
+                    return;
+                }
+                synced = written;
+                durable_seq_.store(synced, std::memory_order_release);
+            }
+        }
+
+        if (n != 0) {
+            idle = 0;
+            sleep = std::chrono::microseconds{1};
+        } else if (stopping) {
+            return;
+        } else if (idle < kYieldRounds) {
+            ++idle;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(sleep);
+            sleep = std::min(sleep * 2, cfg_.max_idle_sleep);
+        }
+    }
+}
+
+JournalReader::JournalReader(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        return;
+    }
+
+    const auto size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (!validHeader(header)) {
+        ::munmap(base, size);
+        return;
+    }
+    ::madvise(base, size, MADV_SEQUENTIAL);
+
+    const size_t slots = std::min<uint64_t>(header.capacity, (size - sizeof(FileHeader)) / sizeof(Record));
+    const auto* first = reinterpret_cast<const Record*>(static_cast<const char*>(base) + sizeof(FileHeader));
+    const std::span<const Record> all(first, slots);
+    records_ = all.first(validPrefix(all));
+    base_ = base;
+    mapped_ = size;
+}
+
+JournalReader::~JournalReader() {
+    if (base_ != nullptr) {
+        ::munmap(base_, mapped_);
+    }
+}
+
+}  // namespace journal
+}  // namespace orderbook
@@ -0,0 +1,162 @@
+#include "object_pool.hpp"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace pool {
+namespace detail {
+
+namespace {
+
+constexpr size_t kHugePage = size_t{2} << 20;
+
+size_t pageSize() {
+    static const auto size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t roundUp(size_t n, size_t align) { return (n + align - 1) / align * align; }
+
+bool hugeAligned(const SlabPolicy& policy) { return policy.pages != SlabPolicy::Pages::Default; }
+
+// Mapped length of a slab; unmapSlab recomputes it, so it must depend only on
+// bytes and the policy.
+size_t mappedBytes(size_t bytes, const SlabPolicy& policy) { return roundUp(bytes, hugeAligned(policy) ? kHugePage : pageSize()); }
+
+// Anonymous read-write mapping of len bytes starting on an align boundary:
+// map align bytes more and trim both ends.
+void* mapAligned(size_t len, size_t align) {
+    void* raw = ::mmap(nullptr, len + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    const auto start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t begin = roundUp(start, align);
+    const uintptr_t end = begin + len;
+    if (begin != start) {
+        ::munmap(raw, begin - start);
+    }
+    if (end != start + len + align) {
+        ::munmap(reinterpret_cast<void*>(end), start + len + align - end);
+    }
+    return reinterpret_cast<void*>(begin);
+}
+
+// Fault every page in now. MADV_POPULATE_WRITE does it in one call where the
+// kernel has it (5.14+); otherwise write one byte per page.
+void populate(void* p, size_t len) {
+#ifdef MADV_POPULATE_WRITE
+    if (::madvise(p, len, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    auto* bytes = static_cast<volatile char*>(p);
+    for (size_t off = 0; off < len; off += pageSize()) {
+        bytes[off] = 0;
+    }
+}
+
+void* mapSlab(size_t bytes, const SlabPolicy& policy) {
+    const size_t len = mappedBytes(bytes, policy);
+    void* slab = nullptr;
+    if (policy.pages == SlabPolicy::Pages::Huge) {
+        slab = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (slab == MAP_FAILED) {
+            slab = nullptr;
+        }
+    }
+    if (slab == nullptr) {
+        slab = mapAligned(len, hugeAligned(policy) ? kHugePage : pageSize());
+        if (slab == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (hugeAligned(policy)) {
+            ::madvise(slab, len, MADV_HUGEPAGE);
+        }
+    }
+
+    // Bind before anything faults a page in, so every page lands on the node.
+    // mlock faults the whole slab in itself.
+    if (policy.numa_node >= 0 && policy.numa_node < 64) {
+        const unsigned long mask = 1ul << policy.numa_node;
+        ::syscall(SYS_mbind, slab, len, MPOL_BIND, &mask, 64ul, 0u);
+    }
+    if (policy.lock) {
+        ::mlock(slab, len);
+    }
+    if (policy.prefault) {
+        populate(slab, len);
+    }
+    return slab;
+}
+
+void unmapSlab(void* slab, size_t bytes, const SlabPolicy& policy) { ::munmap(slab, mappedBytes(bytes, policy)); }
+
+}  // namespace
+
+void* allocateSlab(size_t bytes, size_t align, const SlabPolicy& policy) {
+    return policy.mapped() ? mapSlab(bytes, policy) : ::operator new[](bytes, std::align_val_t{align});
+}
+
+void freeSlab(void* slab, size_t bytes, size_t align, const SlabPolicy& policy) {
+    if (policy.mapped()) {
+        unmapSlab(slab, bytes, policy);
+    } else {
+        ::operator delete[](slab, std::align_val_t{align});
+    }
+}
+
+}  // namespace detail
+
+SlabGrower::SlabGrower() : thread_([this] { run(); }) {}
+
+SlabGrower::~SlabGrower() {
+    post(&stop_);
+    thread_.join();
+}
+
+void SlabGrower::post(SlabRequest* request) {
+    request->next = requests_.load(std::memory_order_relaxed);
+    while (!requests_.compare_exchange_weak(request->next, request, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    requests_.notify_one();
+}
+
+void SlabGrower::run() {
+    for (bool stopping = false; !stopping;) {
+        requests_.wait(nullptr, std::memory_order_acquire);
+        for (SlabRequest* r = requests_.exchange(nullptr, std::memory_order_acquire); r != nullptr;) {
+            // The owner may reuse the request as soon as it is ready.
+            SlabRequest* next = r->next;
+            if (r == &stop_) {
+                stopping = true;
+            } else {
+                char* slab = nullptr;
+                try {
+                    slab = static_cast<char*>(detail::allocateSlab(r->count * r->slot_size, r->align, r->policy));
+                } catch (const std::bad_alloc&) {
+                }
+                if (slab != nullptr) {
+                    for (size_t i = 0; i + 1 < r->count; ++i) {
+                        void* succ = slab + (i + 1) * r->slot_size;
+                        std::memcpy(slab + i * r->slot_size, &succ, sizeof(succ));
+                    }
+                    void* last = nullptr;
+                    std::memcpy(slab + (r->count - 1) * r->slot_size, &last, sizeof(last));
+                }
+                r->slab = slab;
+                r->ready.store(true, std::memory_order_release);
+            }
+            r = next;
+        }
+    }
+}
+
+}  // namespace pool
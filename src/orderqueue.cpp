@@ -14,7 +14,7 @@ Decimal OrderQueue::price() const { return price_; }
 
 Decimal OrderQueue::totalQty() const { return total_qty_; }
 
-uint64_t OrderQueue::len() { return orders_.size(); }
+uint64_t OrderQueue::len() const { return orders_.size(); }
 
 void OrderQueue::append(Order* order) {
     total_qty_ += order->qty;
@@ -29,7 +29,18 @@ void OrderQueue::remove(Order* o) {
     }
 }
 
+// Shrink a resting order in place. The order keeps its position in the FIFO, so
+// a quantity-down amend does not lose time priority.
+void OrderQueue::reduce(Order* o, Decimal qty) {
+    total_qty_ -= o->qty - qty;
+    o->qty = qty;
+}
+
+// Every order in the queue rests at price_, so the loop reads only each maker's
+// hook, id and qty. The price is copied up front: postFill can erase the last
+// order and with it this queue.
 Decimal OrderQueue::process(const TradeNotification& tradeNotification, const PostOrderFill& postFill, OrderID takerOrderID, Decimal qty) {
+    const Decimal price = price_;
     Decimal qtyProcessed = {};
     BOOST_ASSERT(orders_.begin() != orders_.end());
     for (auto it = orders_.begin(); it != orders_.end() && qty > uint64_t(0);) {
@@ -41,11 +52,10 @@ Decimal OrderQueue::process(const TradeNotification& tradeNotification, const Po
             qtyProcessed += qty;
             ho->qty -= qty;
             total_qty_ -= qty;
-            tradeNotification(ho->id, takerOrderID, OrderStatus::FilledPartial, OrderStatus::FilledComplete, qty, ho->price);
+            tradeNotification(ho->id, takerOrderID, OrderStatus::FilledPartial, OrderStatus::FilledComplete, qty, price);
             break;
         } else {
             const auto makerOrderID = ho->id;
-            const auto makerPrice = ho->price;
             auto matchedQty = ho->qty;
             qtyProcessed += matchedQty;
             qty -= matchedQty;
@@ -56,7 +66,7 @@ Decimal OrderQueue::process(const TradeNotification& tradeNotification, const Po
             postFill(makerOrderID);
             // qty has already been decremented by matchedQty, so zero means taker is fully filled.
             const auto takerStatus = qty.is_zero() ? OrderStatus::FilledComplete : OrderStatus::FilledPartial;
-            tradeNotification(makerOrderID, takerOrderID, OrderStatus::FilledComplete, takerStatus, matchedQty, makerPrice);
+            tradeNotification(makerOrderID, takerOrderID, OrderStatus::FilledComplete, takerStatus, matchedQty, price);
         }
     }
 
@@ -52,6 +52,26 @@ void PriceLevel<P, Store>::remove(Order* order) {
     volume_ -= order->qty;
 }
 
+// Quantity-down amend: the order stays where it is in its queue.
+template <PriceType P, class Store>
+void PriceLevel<P, Store>::reduce(Order* order, Decimal qty) {
+    volume_ -= order->qty - qty;
+    order->queue->reduce(order, qty);
+}
+
+// Same-price amend that loses time priority (quantity up): move the order to
+// the back of its own queue. The queue is never empty in between, so the level
+// is not erased and re-created.
+template <PriceType P, class Store>
+void PriceLevel<P, Store>::requeue(Order* order, Decimal qty) {
+    OrderQueue* q = order->queue;
+    q->remove(order);
+    volume_ -= order->qty;
+    order->qty = qty;
+    volume_ += qty;
+    q->append(order);
+}
+
 template <PriceType P, class Store>
 OrderQueue* PriceLevel<P, Store>::getQueue() {
     return store_.best();
@@ -28,6 +28,8 @@ std::ostream& operator<<(std::ostream& os, const MsgType& msgType) {
             return os << "CreateOrder";
         case MsgType::CancelOrder:
             return os << "CancelOrder";
+        case MsgType::ModifyOrder:
+            return os << "ModifyOrder";
     }
     return os << "Unknown";
 }
@@ -104,6 +106,20 @@ std::ostream& operator<<(std::ostream& os, const ExecType& execType) {
             return os << "Canceled";
         case ExecType::Trade:
             return os << "Trade";
+        case ExecType::Replaced:
+            return os << "Replaced";
+    }
+    return os << "Unknown";
+}
+
+std::ostream& operator<<(std::ostream& os, const CommandType& commandType) {
+    switch (commandType) {
+        case CommandType::Add:
+            return os << "Add";
+        case CommandType::Cancel:
+            return os << "Cancel";
+        case CommandType::Modify:
+            return os << "Modify";
     }
     return os << "Unknown";
 }
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "book_manager.hpp"
+#include "util.cpp"
+
+using orderbook::BookManager;
+using orderbook::BookManagerConfig;
+using orderbook::Command;
+using orderbook::CommandType;
+using orderbook::RingReportSink;
+using orderbook::SpscRing;
+using orderbook::SymbolCommand;
+using orderbook::SymbolID;
+using orderbook::SymbolReport;
+
+namespace {
+
+std::string format(const SymbolReport& r) {
+    std::ostringstream os;
+    std::visit(
+        [&os](const auto& rep) {
+            using R = std::decay_t<decltype(rep)>;
+            if constexpr (std::is_same_v<R, orderbook::TradeReport>) {
+                os << "T " << rep.maker_order_id << " " << rep.taker_order_id << " " << rep.qty << " " << rep.price;
+            } else if constexpr (std::is_same_v<R, orderbook::RejectReport>) {
+                os << "R " << rep.msg_type << " " << rep.order_id << " " << rep.error;
+            } else {
+                os << "O " << rep.msg_type << " " << rep.order_id << " " << rep.qty << " " << rep.original_qty;
+            }
+        },
+        r.report);
+    return os.str();
+}
+
+// Random add / cancel / modify traffic spread over nsymbols symbols.
+std::vector<SymbolCommand> randomTraffic(size_t count, SymbolID nsymbols, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<SymbolID> symbol(0, nsymbols - 1);
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<OrderID> id(1, 100);
+    std::uniform_int_distribution<int> qty(1, 10);
+    std::uniform_int_distribution<int> price(95, 105);
+
+    std::vector<SymbolCommand> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Command c;
+        const int k = kind(rng);
+        c.id = id(rng);
+        c.qty = Decimal(qty(rng), 0);
+        c.price = Decimal(price(rng), 0);
+        c.side = (rng() & 1) ? Side::Buy : Side::Sell;
+        if (k < 6) {
+            c.kind = CommandType::Add;
+            c.type = k == 0 ? Type::Market : Type::Limit;
+        } else if (k < 8) {
+            c.kind = CommandType::Cancel;
+        } else {
+            c.kind = CommandType::Modify;
+        }
+        out.push_back({symbol(rng), c});
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(BookManagerTest, PerSymbolReportsMatchSequentialBooks) {
+    constexpr SymbolID kSymbols = 64;
+    const auto traffic = randomTraffic(200000, kSymbols, 8675309);
+
+    // Reference: every symbol applied sequentially on this thread.
+    std::map<SymbolID, std::vector<std::string>> expected;
+    {
+        SpscRing<SymbolReport> ring(1 << 8);
+        std::vector<std::unique_ptr<RingReportSink>> sinks;
+        std::vector<std::unique_ptr<OrderBook<RingReportSink>>> books;
+        for (SymbolID s = 0; s < kSymbols; ++s) {
+            sinks.push_back(std::make_unique<RingReportSink>(s, ring, orderbook::WaitStrategy::Spin));
+            books.push_back(std::make_unique<OrderBook<RingReportSink>>(*sinks.back(), 64, 256, 256, 0, 100000000, 256));
+        }
+        for (const auto& sc : traffic) {
+            books[sc.symbol]->apply(sc.cmd);
+            ring.consume(ring.capacity(), [&](const SymbolReport& r) { expected[r.symbol].push_back(format(r)); });
+        }
+    }
+
+    BookManager<> manager(BookManagerConfig{.workers = 4, .cpus = {}, .inbound_capacity = 1 << 10, .outbound_capacity = 1 << 10});
+    for (SymbolID s = 0; s < kSymbols; ++s) {
+        ASSERT_TRUE(manager.addSymbol(s));
+    }
+    ASSERT_FALSE(manager.addSymbol(3));
+
+    std::atomic<bool> done{false};
+    std::vector<std::map<SymbolID, std::vector<std::string>>> got(manager.workers());
+    std::vector<std::thread> consumers;
+    for (uint32_t w = 0; w < manager.workers(); ++w) {
+        consumers.emplace_back([&, w] {
+            const auto take = [&](const SymbolReport& r) { got[w][r.symbol].push_back(format(r)); };
+            while (!done.load(std::memory_order_acquire)) {
+                manager.pollReports(w, take);
+            }
+            while (manager.pollReports(w, take) != 0) {
+            }
+        });
+    }
+
+    manager.start();
+    for (const auto& sc : traffic) {
+        while (!manager.submit(sc)) {
+            std::this_thread::yield();
+        }
+    }
+    manager.stop();
+    done.store(true, std::memory_order_release);
+    for (auto& t : consumers) {
+        t.join();
+    }
+
+    size_t total = 0;
+    for (SymbolID s = 0; s < kSymbols; ++s) {
+        const auto& mine = got[manager.workerOf(s)][s];
+        ASSERT_EQ(mine, expected[s]) << "symbol=" << s;
+        total += mine.size();
+    }
+    ASSERT_GT(total, traffic.size());
+
+    // Stopped again: the books are directly readable.
+    ASSERT_NE(manager.book(0), nullptr);
+    ASSERT_EQ(manager.book(kSymbols), nullptr);
+}
+
+TEST(BookManagerTest, RoutingAndRejections) {
+    BookManager<> manager(BookManagerConfig{.workers = 3, .cpus = {}});
+    for (SymbolID s : {10u, 11u, 12u, 13u}) {
+        ASSERT_TRUE(manager.addSymbol(s));
+    }
+    ASSERT_EQ(manager.workerOf(10), 0);
+    ASSERT_EQ(manager.workerOf(11), 1);
+    ASSERT_EQ(manager.workerOf(12), 2);
+    ASSERT_EQ(manager.workerOf(13), 0);
+    ASSERT_EQ(manager.workerOf(99), BookManager<>::kNoWorker);
+    ASSERT_EQ(manager.workerOf(4'000'000'000u), BookManager<>::kNoWorker);
+
+    const Command add{.kind = CommandType::Add, .type = Type::Limit, .side = Side::Buy, .id = 1, .qty = Decimal(1, 0), .price = Decimal(100, 0)};
+    ASSERT_FALSE(manager.submit(99, add));
+
+    manager.start();
+    ASSERT_FALSE(manager.addSymbol(20));
+    ASSERT_TRUE(manager.submit(12, add));
+    manager.stop();
+
+    std::vector<SymbolReport> reports;
+    manager.pollReports(2, [&](const SymbolReport& r) { reports.push_back(r); });
+    ASSERT_EQ(reports.size(), 1);
+    ASSERT_EQ(reports[0].symbol, 12);
+    ASSERT_EQ(format(reports[0]), "O CreateOrder 1 1 1");
+    ASSERT_TRUE(manager.book(12)->hasOrder(1));
+    ASSERT_FALSE(manager.book(13)->hasOrder(1));
+}
+
+TEST(BookManagerTest, SymbolIdsAboveTheConfiguredMaximumAreRejected) {
+    BookManager<> manager(BookManagerConfig{.workers = 1, .cpus = {}, .max_symbol_id = 1000});
+    ASSERT_TRUE(manager.addSymbol(1000));
+    ASSERT_FALSE(manager.addSymbol(1001));
+    ASSERT_FALSE(manager.addSymbol(4'000'000'000u));
+    ASSERT_FALSE(manager.hasSymbol(4'000'000'000u));
+    ASSERT_EQ(manager.book(4'000'000'000u), nullptr);
+    ASSERT_EQ(manager.workerOf(1001), BookManager<>::kNoWorker);
+}
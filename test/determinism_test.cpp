@@ -3,11 +3,15 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <span>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <vector>
 
+#include "direct_index.hpp"
 #include "rbtree_levels.hpp"
+#include "swiss_index.hpp"
 #include "util.cpp"
 
 // Level-store policy under test. Defaults to ArrayLevels; a parallel CMake
@@ -53,6 +57,9 @@ class DeterminismTest : public ::testing::Test {
         return std::tuple{notification.Strings(), localOb->toString(), localOb->last_price};
     }
 
+    // Adds of all types and flags.
+    static constexpr CommandMix kAllFlags{.flags = CommandMix::Flags::All};
+
     static bool hasExactReport(const std::vector<std::string>& reports, const std::string& expected) {
         return std::find(reports.begin(), reports.end(), expected) != reports.end();
     }
@@ -213,6 +220,69 @@ TEST_F(DeterminismTest, RecoverAtEveryMidpointThenReplaySuffix) {
     }
 }
 
+TEST_F(DeterminismTest, SnapshotAtEveryMidpointThenReplaySuffix) {
+    const auto actions = marketAActions();
+
+    for (size_t split = 0; split <= actions.size(); ++split) {
+        Notification baselineN;
+        auto baselineOb = std::make_shared<TestBook>(baselineN);
+        for (size_t i = 0; i < split; ++i) {
+            applyAction(actions[i], baselineOb);
+        }
+        std::stringstream snap;
+        ASSERT_TRUE(baselineOb->saveSnapshot(snap)) << "split=" << split;
+        const auto snapshotBookState = baselineOb->toString();
+
+        baselineN.Reset();
+        for (size_t i = split; i < actions.size(); ++i) {
+            applyAction(actions[i], baselineOb);
+        }
+
+        Notification restoredN;
+        auto restoredOb = std::make_shared<TestBook>(restoredN);
+        ASSERT_TRUE(restoredOb->loadSnapshot(snap)) << "split=" << split;
+        ASSERT_TRUE(restoredN.Strings().empty()) << "split=" << split;
+        ASSERT_EQ(restoredOb->toString(), snapshotBookState) << "split=" << split;
+
+        for (size_t i = split; i < actions.size(); ++i) {
+            applyAction(actions[i], restoredOb);
+        }
+
+        ASSERT_EQ(restoredN.Strings(), baselineN.Strings()) << "split=" << split;
+        ASSERT_EQ(restoredOb->toString(), baselineOb->toString()) << "split=" << split;
+        ASSERT_EQ(restoredOb->last_price, baselineOb->last_price) << "split=" << split;
+    }
+}
+
+// Same, over a long random stream with modifies: FIFO order inside each level
+// must survive the round trip or the suffix fills would differ.
+TEST_F(DeterminismTest, SnapshotRoundTripPreservesQueuePriority) {
+    const auto cmds = randomCommands(4000, 7031, kAllFlags);
+
+    for (size_t split : {size_t(500), size_t(2000), size_t(3999)}) {
+        Notification baselineN;
+        auto baselineOb = std::make_shared<TestBook>(baselineN);
+        for (size_t i = 0; i < split; ++i) {
+            baselineOb->apply(cmds[i]);
+        }
+        std::stringstream snap;
+        ASSERT_TRUE(baselineOb->saveSnapshot(snap));
+
+        Notification restoredN;
+        auto restoredOb = std::make_shared<TestBook>(restoredN);
+        ASSERT_TRUE(restoredOb->loadSnapshot(snap));
+
+        baselineN.Reset();
+        for (size_t i = split; i < cmds.size(); ++i) {
+            baselineOb->apply(cmds[i]);
+            restoredOb->apply(cmds[i]);
+        }
+
+        ASSERT_EQ(restoredN.Strings(), baselineN.Strings()) << "split=" << split;
+        ASSERT_EQ(restoredOb->toString(), baselineOb->toString()) << "split=" << split;
+    }
+}
+
 TEST_F(DeterminismTest, TwoCopiesPerMarketRemainDeterministicWithDifferentInterleavedMarkets) {
     const auto marketA = marketAActions();
     const auto marketB = marketBActions();
@@ -286,3 +356,71 @@ TEST_F(DeterminismTest, TwoCopiesPerMarketRemainDeterministicWithDifferentInterl
     ASSERT_TRUE(hasReportContaining(nB1.Strings(), "CancelOrder Canceled"));
     ASSERT_TRUE(hasReportContaining(nB1.Strings(), "CancelOrder Rejected"));
 }
+
+TEST_F(DeterminismTest, ProcessBatchMatchesSequentialApply) {
+    const auto cmds = randomCommands(5000, 20240917, kAllFlags);
+
+    Notification sequentialN;
+    auto sequentialOb = std::make_shared<TestBook>(sequentialN);
+    for (const auto& c : cmds) {
+        sequentialOb->apply(c);
+    }
+    ASSERT_TRUE(hasReportContaining(sequentialN.Strings(), "Filled"));
+    ASSERT_TRUE(hasReportContaining(sequentialN.Strings(), "ModifyOrder Accepted"));
+    ASSERT_TRUE(hasReportContaining(sequentialN.Strings(), "CancelOrder Canceled"));
+
+    for (size_t batch : {size_t(1), size_t(3), size_t(32), size_t(256), cmds.size()}) {
+        Notification batchN;
+        auto batchOb = std::make_shared<TestBook>(batchN);
+        const std::span<const orderbook::Command> all(cmds);
+        for (size_t off = 0; off < all.size(); off += batch) {
+            batchOb->processBatch(all.subspan(off, std::min(batch, all.size() - off)));
+        }
+
+        ASSERT_EQ(batchN.Strings(), sequentialN.Strings()) << "batch=" << batch;
+        ASSERT_EQ(batchOb->toString(), sequentialOb->toString()) << "batch=" << batch;
+        ASSERT_EQ(batchOb->last_price, sequentialOb->last_price) << "batch=" << batch;
+    }
+}
+
+// Drive a book built on Index through processBatch and compare it with the
+// default index applying the same commands one by one. Small pools and index
+// make the order and node pools take several slabs and the index rehash.
+template <class Index>
+void expectIndexMatchesDefault(const std::vector<orderbook::Command>& cmds) {
+    using IndexBook = orderbook::OrderBook<Notification, TestLevels, orderbook::NoMarketData, orderbook::NoStats, Index>;
+
+    Notification defaultN;
+    TestBook defaultOb(defaultN);
+    for (const auto& c : cmds) {
+        defaultOb.apply(c);
+    }
+
+    Notification indexN;
+    IndexBook indexOb(indexN, 16, 3, 4);
+    indexOb.processBatch(cmds);
+
+    ASSERT_EQ(indexN.Strings(), defaultN.Strings());
+    ASSERT_EQ(indexOb.toString(), defaultOb.toString());
+    const auto s = indexOb.stats();
+    ASSERT_GT(s.order_pool_slabs, 1);
+    ASSERT_GT(s.index_rehashes, 0);
+}
+
+TEST_F(DeterminismTest, CompactIndexMatchesDefaultIndex) { expectIndexMatchesDefault<orderbook::index::CompactFibHashIndex>(randomCommands(20000, 7, kAllFlags)); }
+
+TEST_F(DeterminismTest, SwissIndexMatchesDefaultIndex) { expectIndexMatchesDefault<orderbook::index::SwissIndex>(randomCommands(20000, 7, kAllFlags)); }
+
+TEST_F(DeterminismTest, DirectIndexMatchesDefaultIndex) {
+    // Slide the ids upwards so the direct index allocates, retires and reuses
+    // pages as it would under engine-assigned ids.
+    auto cmds = randomCommands(20000, 7, kAllFlags);
+    for (size_t i = 0; i < cmds.size(); ++i) {
+        cmds[i].id += i / 256 * 100;
+    }
+    expectIndexMatchesDefault<orderbook::index::DirectIndex>(cmds);
+}
+
+TEST_F(DeterminismTest, IncrementalIndexMatchesDefaultIndex) {
+    expectIndexMatchesDefault<orderbook::index::IncrementalFibHashIndex>(randomCommands(20000, 7, kAllFlags));
+}
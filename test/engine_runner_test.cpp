@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine_runner.hpp"
+#include "util.cpp"
+
+using orderbook::Command;
+using orderbook::CommandType;
+using orderbook::EngineRunner;
+using orderbook::EngineRunnerConfig;
+using orderbook::RingReportSink;
+using orderbook::SpscRing;
+using orderbook::SymbolReport;
+using orderbook::WaitStrategy;
+
+namespace {
+
+std::string format(const SymbolReport& r) {
+    std::ostringstream os;
+    os << r.symbol << " ";
+    std::visit(
+        [&os](const auto& rep) {
+            using R = std::decay_t<decltype(rep)>;
+            if constexpr (std::is_same_v<R, orderbook::TradeReport>) {
+                os << "T " << rep.maker_order_id << " " << rep.taker_order_id << " " << rep.qty << " " << rep.price;
+            } else if constexpr (std::is_same_v<R, orderbook::RejectReport>) {
+                os << "R " << rep.msg_type << " " << rep.order_id << " " << rep.error;
+            } else {
+                os << "O " << rep.msg_type << " " << rep.order_id << " " << rep.qty << " " << rep.original_qty;
+            }
+        },
+        r.report);
+    return os.str();
+}
+
+}  // namespace
+
+class EngineRunnerTest : public ::testing::TestWithParam<WaitStrategy> {};
+
+TEST_P(EngineRunnerTest, ReportsMatchSequentialBookAndStopDrains) {
+    const auto cmds = randomCommands(100000, 31337, {.max_id = 300, .adds = 6, .flags = CommandMix::Flags::None});
+
+    std::vector<std::string> expected;
+    {
+        SpscRing<SymbolReport> ring(1 << 8);
+        RingReportSink sink(5, ring, WaitStrategy::Spin);
+        OrderBook<RingReportSink> book(sink);
+        for (const auto& c : cmds) {
+            book.apply(c);
+            ring.consume(ring.capacity(), [&](const SymbolReport& r) { expected.push_back(format(r)); });
+        }
+    }
+
+    EngineRunner<> runner(EngineRunnerConfig{.wait = GetParam(), .inbound_capacity = 1 << 10, .outbound_capacity = 1 << 10, .symbol = 5});
+    std::atomic<bool> done{false};
+    std::vector<std::string> got;
+    std::thread consumer([&] {
+        const auto take = [&](const SymbolReport& r) { got.push_back(format(r)); };
+        while (!done.load(std::memory_order_acquire)) {
+            runner.pollReports(take);
+        }
+        while (runner.pollReports(take) != 0) {
+        }
+    });
+
+    runner.start();
+    ASSERT_TRUE(runner.running());
+    for (const auto& c : cmds) {
+        while (!runner.submit(c)) {
+            std::this_thread::yield();
+        }
+    }
+    // Stop right after the last submit: everything queued is still applied.
+    runner.stop();
+    ASSERT_FALSE(runner.running());
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    ASSERT_EQ(got, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(WaitStrategies, EngineRunnerTest, ::testing::Values(WaitStrategy::Spin, WaitStrategy::Pause, WaitStrategy::Yield));
+
+TEST(EngineRunnerBookArgsTest, ForwardsBookConstructorArguments) {
+    // A 0.5 tick grid: an order at 100.5 rests on its own level.
+    EngineRunner<> runner(EngineRunnerConfig{}, 64, 64, 64, 0, 50000000, 512);
+    runner.start();
+    ASSERT_TRUE(runner.submit({.kind = CommandType::Add, .type = Type::Limit, .side = Side::Buy, .id = 1, .qty = Decimal(2, 0), .price = Decimal("100.5")}));
+    runner.stop();
+
+    ASSERT_EQ(runner.book().depthAt(Side::Buy, Decimal("100.5")), Decimal(2, 0));
+    std::vector<std::string> got;
+    runner.pollReports([&](const SymbolReport& r) { got.push_back(format(r)); });
+    ASSERT_EQ(got, std::vector<std::string>{"0 O CreateOrder 1 2 2"});
+}
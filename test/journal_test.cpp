@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "journal.hpp"
+#include "util.cpp"
+
+using orderbook::Command;
+using orderbook::CommandType;
+using orderbook::journal::Journal;
+using orderbook::journal::JournalConfig;
+using orderbook::journal::JournaledBook;
+using orderbook::journal::JournalReader;
+using orderbook::journal::Record;
+
+using TestBook = orderbook::OrderBook<Notification>;
+
+class JournalTest : public ::testing::Test {
+   protected:
+    std::string path;
+
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = (std::filesystem::temp_directory_path() / ("ob_journal_" + std::to_string(::getpid()) + "_" + info->name() + ".wal")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    // Append with retry: the tests produce faster than a disk can sync.
+    static void append(Journal& journal, const Command& cmd) {
+        while (!journal.tryAppend(cmd)) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+TEST_F(JournalTest, ReplayReproducesLiveBook) {
+    const auto cmds = randomCommands(5000, 424242);
+
+    Notification liveN;
+    TestBook live(liveN);
+    {
+        Journal journal(path, JournalConfig{.capacity_records = 8192, .ring_capacity = 8192});
+        ASSERT_TRUE(journal.ok());
+        JournaledBook front(journal, live);
+        for (const auto& c : cmds) {
+            ASSERT_TRUE(front.apply(c));
+        }
+        ASSERT_EQ(journal.lastSeq(), cmds.size());
+        journal.close();
+        ASSERT_EQ(journal.durableSeq(), cmds.size());
+    }
+
+    JournalReader reader(path);
+    ASSERT_TRUE(reader.ok());
+    ASSERT_EQ(reader.records().size(), cmds.size());
+
+    Notification replayN;
+    TestBook replayed(replayN);
+    ASSERT_EQ(reader.replay(replayed), cmds.size());
+    ASSERT_EQ(replayN.Strings(), liveN.Strings());
+    ASSERT_EQ(replayed.toString(), live.toString());
+    ASSERT_EQ(replayed.last_price, live.last_price);
+}
+
+TEST_F(JournalTest, GroupCommitAdvancesDurableSeqWhileRunning) {
+    Journal journal(path, JournalConfig{.capacity_records = 1024, .sync_every_records = 1000000, .sync_interval = std::chrono::microseconds(100)});
+    ASSERT_TRUE(journal.ok());
+    for (const auto& c : randomCommands(100, 1)) {
+        append(journal, c);
+    }
+
+    // Far below sync_every_records, so only the time trigger can sync these.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (journal.durableSeq() != 100 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(journal.durableSeq(), 100);
+}
+
+TEST_F(JournalTest, ReopenContinuesAfterLastRecord) {
+    const auto cmds = randomCommands(300, 99);
+    {
+        Journal journal(path, JournalConfig{.capacity_records = 1024});
+        for (size_t i = 0; i < 200; ++i) {
+            append(journal, cmds[i]);
+        }
+    }
+    {
+        Journal journal(path, JournalConfig{.capacity_records = 1});  // capacity comes from the file
+        ASSERT_TRUE(journal.ok());
+        ASSERT_EQ(journal.lastSeq(), 200);
+        ASSERT_EQ(journal.durableSeq(), 200);
+        for (size_t i = 200; i < cmds.size(); ++i) {
+            append(journal, cmds[i]);
+        }
+    }
+
+    JournalReader reader(path);
+    ASSERT_EQ(reader.records().size(), cmds.size());
+
+    // Replaying the tail on top of a book that already holds the head.
+    Notification fullN;
+    TestBook full(fullN);
+    for (const auto& c : cmds) {
+        full.apply(c);
+    }
+    Notification splitN;
+    TestBook split(splitN);
+    for (size_t i = 0; i < 200; ++i) {
+        split.apply(cmds[i]);
+    }
+    ASSERT_EQ(reader.replay(split, 200), cmds.size());
+    ASSERT_EQ(split.toString(), full.toString());
+}
+
+TEST_F(JournalTest, TornRecordEndsTheJournal) {
+    {
+        Journal journal(path, JournalConfig{.capacity_records = 64});
+        for (const auto& c : randomCommands(10, 5)) {
+            append(journal, c);
+        }
+    }
+
+    // Flip a byte inside record 8 as a crash mid-write would leave it.
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(orderbook::journal::FileHeader) + 7 * sizeof(Record) + 9);
+        f.put('\x5a');
+    }
+
+    JournalReader reader(path);
+    ASSERT_TRUE(reader.ok());
+    ASSERT_EQ(reader.records().size(), 7);
+
+    Journal reopened(path);
+    ASSERT_EQ(reopened.lastSeq(), 7);
+}
+
+TEST_F(JournalTest, ReopenClearsRecordsPastATornOne) {
+    const auto cmds = randomCommands(40, 17);
+    {
+        Journal journal(path, JournalConfig{.capacity_records = 64});
+        for (size_t i = 0; i < 30; ++i) {
+            append(journal, cmds[i]);
+        }
+    }
+
+    // Record 11 torn; 12..30 are still intact on disk.
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(sizeof(orderbook::journal::FileHeader) + 10 * sizeof(Record) + 9);
+        f.put('\x5a');
+    }
+
+    // The next run rewrites only 11..15. Without clearing, the old 16..30
+    // would follow them with matching seqs and checksums.
+    {
+        Journal journal(path);
+        ASSERT_EQ(journal.lastSeq(), 10);
+        for (size_t i = 30; i < 35; ++i) {
+            append(journal, cmds[i]);
+        }
+    }
+
+    JournalReader reader(path);
+    ASSERT_EQ(reader.records().size(), 15);
+    for (size_t i = 10; i < 15; ++i) {
+        ASSERT_EQ(reader.records()[i].id, cmds[i + 20].id);
+    }
+    Journal reopened(path);
+    ASSERT_EQ(reopened.lastSeq(), 15);
+}
+
+TEST_F(JournalTest, IdleWriterSleeps) {
+    Journal journal(path, JournalConfig{.capacity_records = 64});
+    // Let the writer settle into its longest sleep, then take the process's
+    // CPU time over 100 ms in which this thread only sleeps: the idle writer
+    // alone should use well under 10 ms of it.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    timespec before{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &before);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    timespec after{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &after);
+    const auto used_ns = (after.tv_sec - before.tv_sec) * 1000000000L + (after.tv_nsec - before.tv_nsec);
+    ASSERT_LT(used_ns, 10000000L);
+}
+
+TEST_F(JournalTest, RefusesWhenFullOrClosed) {
+    Journal journal(path, JournalConfig{.capacity_records = 5});
+    const auto cmds = randomCommands(6, 3);
+    for (size_t i = 0; i < 5; ++i) {
+        append(journal, cmds[i]);
+    }
+    ASSERT_FALSE(journal.tryAppend(cmds[5]));
+
+    Notification n;
+    TestBook book(n);
+    JournaledBook front(journal, book);
+    ASSERT_FALSE(front.addOrder(1, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(100, 0), Flag::None));
+    ASSERT_TRUE(n.Strings().empty());
+
+    journal.close();
+    ASSERT_FALSE(journal.ok());
+    ASSERT_EQ(journal.durableSeq(), 5);
+
+    ASSERT_FALSE(Journal("/nonexistent-dir/journal.wal").ok());
+    ASSERT_FALSE(JournalReader("/nonexistent-dir/journal.wal").ok());
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "util.cpp"
+
+namespace orderbook::test {
+
+class ObjectPoolTest : public ::testing::Test {
+   protected:
+    void SetUp() override {}
+
+    void TearDown() override {}
+};
+
+TEST_F(ObjectPoolTest, TestObjectPool_HandlesRoundTripAcrossSlabs) {
+    // 3 rounds up to a first slab of 4, then 8, 16, 32.
+    pool::ObjectPool<Order> p(3);
+    std::vector<Order*> orders;
+    std::set<pool::ObjectPool<Order>::Handle> handles;
+    for (OrderID id = 1; id <= 50; ++id) {
+        orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+    }
+    ASSERT_EQ(p.slabs(), 4);
+
+    for (auto* o : orders) {
+        const auto h = p.handle(o);
+        ASSERT_NE(h, pool::ObjectPool<Order>::kNullHandle);
+        ASSERT_LT(h, 60);
+        ASSERT_EQ(p.get(h), o);
+        ASSERT_TRUE(handles.insert(h).second) << "duplicate handle " << h;
+    }
+
+    Order outside(99, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    ASSERT_EQ(p.handle(&outside), pool::ObjectPool<Order>::kNullHandle);
+
+    // A recycled slot keeps its handle.
+    const auto h = p.handle(orders[7]);
+    p.release(orders[7]);
+    Order* again = p.acquire(7, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    ASSERT_EQ(again, orders[7]);
+    ASSERT_EQ(p.handle(again), h);
+
+    for (auto* o : orders) {
+        p.release(o);
+    }
+}
+
+TEST_F(ObjectPoolTest, TestObjectPool_MappedSlabPolicies) {
+    using Pages = pool::SlabPolicy::Pages;
+    // Huge falls back to transparent huge pages where none are reserved, and
+    // lock / numa_node are best effort, so every policy must work anywhere.
+    const pool::SlabPolicy policies[] = {
+        {.prefault = true},
+        {.pages = Pages::Transparent},
+        {.pages = Pages::Huge, .prefault = true, .lock = true},
+        {.pages = Pages::Transparent, .prefault = true, .numa_node = 0},
+    };
+    for (const auto& policy : policies) {
+        pool::ObjectPool<Order> p(3, policy);
+        ASSERT_TRUE(p.policy().mapped());
+        std::vector<Order*> orders;
+        for (OrderID id = 1; id <= 50; ++id) {
+            orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+        }
+        ASSERT_EQ(p.slabs(), 4);
+        for (size_t i = 0; i < orders.size(); ++i) {
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(orders[i]) % alignof(Order), 0);
+            ASSERT_EQ(p.get(p.handle(orders[i])), orders[i]);
+            ASSERT_EQ(orders[i]->id, i + 1);
+        }
+        if (policy.pages == Pages::Transparent) {
+            // Handle 0 is the first slot of the first slab.
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(p.get(0)) % (size_t{2} << 20), 0);
+        }
+        for (auto* o : orders) {
+            p.release(o);
+        }
+    }
+}
+
+TEST_F(ObjectPoolTest, TestObjectPool_TrimReleasesEmptySlabs) {
+    // Slabs of 4, 8, 16, 32 and 64.
+    pool::ObjectPool<Order> p(4);
+    std::vector<Order*> orders;
+    for (OrderID id = 1; id <= 100; ++id) {
+        orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+    }
+    ASSERT_EQ(p.occupancy(), (std::vector<size_t>{4, 8, 16, 32, 40}));
+
+    // Keep the first slab and one order in the 16 slab live.
+    std::vector<pool::ObjectPool<Order>::Handle> handles;
+    for (size_t i = 0; i < orders.size(); ++i) {
+        if (i < 4 || i == 20) {
+            handles.push_back(p.handle(orders[i]));
+        } else {
+            p.release(orders[i]);
+        }
+    }
+    ASSERT_EQ(p.occupancy(), (std::vector<size_t>{4, 0, 1, 0, 0}));
+
+    // A pass in steps: the free list runs from the last release back, so the
+    // 64 slab's released slots come first, then the whole 32 slab. keep_free
+    // holds back the 64 slab.
+    ASSERT_EQ(p.trim(60, 40), 0);
+    ASSERT_TRUE(p.trimming());
+    ASSERT_EQ(p.occupancy(), (std::vector<size_t>{4, 0, 1, 0, 0}));
+    ASSERT_EQ(p.trim(60, 32), 32 * sizeof(Order));
+    ASSERT_TRUE(p.trimming());
+    ASSERT_EQ(p.trim(60), 8 * sizeof(Order));
+    ASSERT_FALSE(p.trimming());
+    ASSERT_EQ(p.trim(60), 0);
+    ASSERT_EQ(p.capacity(), 4 + 16 + 64);
+    ASSERT_EQ(p.trim(), 64 * sizeof(Order));
+    ASSERT_EQ(p.capacity(), 4 + 16);
+    ASSERT_EQ(p.occupancy(), (std::vector<size_t>{4, 0, 1, 0, 0}));
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(p.get(handles[i]), orders[i]);
+    }
+    ASSERT_EQ(p.handle(orders[20]), handles[4]);
+
+    // Growth reallocates the released slabs, smallest first, in their old
+    // handle ranges.
+    std::set<pool::ObjectPool<Order>::Handle> seen(handles.begin(), handles.end());
+    std::vector<Order*> again;
+    for (OrderID id = 1; id <= 119; ++id) {
+        again.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+        const auto h = p.handle(again.back());
+        ASSERT_LT(h, 124);
+        ASSERT_EQ(p.get(h), again.back());
+        ASSERT_TRUE(seen.insert(h).second) << "duplicate handle " << h;
+    }
+    ASSERT_EQ(p.capacity(), 124);
+    ASSERT_EQ(p.slabs(), 8);
+    ASSERT_EQ(p.occupancy(), (std::vector<size_t>{4, 8, 16, 32, 64}));
+
+    for (auto* o : again) {
+        p.release(o);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        p.release(orders[i]);
+    }
+    p.release(orders[20]);
+}
+
+// An acquire() that needs the slots a pass has parked takes them back and
+// ends the pass instead of growing the pool.
+TEST_F(ObjectPoolTest, TestObjectPool_AcquireEndsTrimPass) {
+    pool::ObjectPool<Order> p(4);
+    std::vector<Order*> orders;
+    for (OrderID id = 1; id <= 13; ++id) {
+        orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+    }
+    for (auto* o : orders) {
+        p.release(o);
+    }
+    ASSERT_EQ(p.capacity(), 4 + 8 + 16);
+
+    // Park all but one slot: the 4 and 8 slabs go, one slot of the 16 slab
+    // stays on the free list.
+    ASSERT_EQ(p.trim(0, 27), 12 * sizeof(Order));
+    ASSERT_TRUE(p.trimming());
+    auto* first = p.acquire(1, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    ASSERT_TRUE(p.trimming());
+    auto* second = p.acquire(2, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    ASSERT_FALSE(p.trimming());
+    ASSERT_EQ(p.slabs(), 3);
+    ASSERT_EQ(p.stalls(), 2);
+    ASSERT_EQ(p.capacity(), 16);
+    ASSERT_EQ(p.occupancy(), (std::vector<size_t>{0, 0, 2}));
+    p.release(first);
+    p.release(second);
+}
+
+TEST_F(ObjectPoolTest, TestObjectPool_GrowerPreallocatesSlabs) {
+    pool::SlabGrower grower;
+    {
+        // Paced acquires: each slab is requested a quarter of the pool before
+        // the free list runs out, and waited for here, so it is adopted before
+        // it is needed and acquire() never stalls.
+        pool::ObjectPool<Order> p(64, {.grower = &grower});
+        std::vector<Order*> orders;
+        for (OrderID id = 1; id <= 1000; ++id) {
+            orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+            while (p.growing()) {
+                std::this_thread::yield();
+            }
+        }
+        ASSERT_EQ(p.slabs(), 5);
+        ASSERT_EQ(p.stalls(), 0);
+        std::set<pool::ObjectPool<Order>::Handle> handles;
+        for (size_t i = 0; i < orders.size(); ++i) {
+            ASSERT_EQ(p.get(p.handle(orders[i])), orders[i]);
+            ASSERT_EQ(orders[i]->id, i + 1);
+            ASSERT_TRUE(handles.insert(p.handle(orders[i])).second);
+        }
+        for (auto* o : orders) {
+            p.release(o);
+        }
+    }
+    {
+        // A burst may outrun the grower and wait for it, but slabs are still
+        // taken in order; the last request is still in flight at destruction.
+        pool::ObjectPool<Order> p(4, {.pages = pool::SlabPolicy::Pages::Transparent, .grower = &grower});
+        std::vector<Order*> orders;
+        for (OrderID id = 1; id <= 4000; ++id) {
+            orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+        }
+        ASSERT_GE(p.slabs(), 10);
+        for (size_t i = 0; i < orders.size(); ++i) {
+            ASSERT_EQ(p.get(p.handle(orders[i])), orders[i]);
+            ASSERT_EQ(orders[i]->id, i + 1);
+        }
+        for (auto* o : orders) {
+            p.release(o);
+        }
+
+        // Trimmed slabs come back through the grower too.
+        ASSERT_GT(p.trim(), 0);
+        for (size_t i = 0; i < orders.size(); ++i) {
+            orders[i] = p.acquire(i + 1, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+            ASSERT_EQ(p.get(p.handle(orders[i])), orders[i]);
+        }
+        for (auto* o : orders) {
+            p.release(o);
+        }
+    }
+}
+
+}  // namespace orderbook::test
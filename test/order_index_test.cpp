@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "direct_index.hpp"
+#include "swiss_index.hpp"
+#include "util.cpp"
+
+namespace orderbook::test {
+
+// Every index policy is checked against std::unordered_map on the same random
+// stream of inserts, erases and lookups.
+template <class Index>
+class OrderIndexTest : public ::testing::Test {
+   protected:
+    pool::ObjectPool<Order> orders{4};
+    std::vector<Order*> held;
+
+    void TearDown() override {
+        for (auto* o : held) {
+            orders.release(o);
+        }
+    }
+
+    Order* newOrder(OrderID id) {
+        held.push_back(orders.acquire(id, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None));
+        return held.back();
+    }
+};
+
+using IndexTypes = ::testing::Types<index::FibHashIndex, index::CompactFibHashIndex, index::IncrementalFibHashIndex, index::BasicFibHashIndex<true, true>,
+                                    index::SwissIndex, index::DirectIndex>;
+TYPED_TEST_SUITE(OrderIndexTest, IndexTypes);
+
+TYPED_TEST(OrderIndexTest, MatchesReferenceMap) {
+    TypeParam idx(this->orders, 4);
+    std::unordered_map<uint64_t, Order*> model;
+    std::vector<Order*> byId;
+
+    std::mt19937_64 rng(19);
+    // Ids drawn from a window that slides upwards, so entries churn the way a
+    // live book's do, plus a few huge ids.
+    uint64_t base = 0;
+    for (int step = 0; step < 200000; ++step) {
+        if (step % 64 == 0) {
+            base += 16;
+        }
+        const uint64_t id = (rng() % 16 == 0) ? rng() : base + rng() % 2048;
+        switch (rng() % 4) {
+            case 0:
+            case 1:
+                if (!model.contains(id)) {
+                    Order* o = this->newOrder(id);
+                    idx.insert(id, o);
+                    model.emplace(id, o);
+                }
+                break;
+            case 2:
+                ASSERT_EQ(idx.erase(id), model.contains(id) ? model[id] : nullptr) << id;
+                model.erase(id);
+                break;
+            default:
+                ASSERT_EQ(idx.find(id), model.contains(id) ? model[id] : nullptr) << id;
+                ASSERT_EQ(idx.contains(id), model.contains(id));
+                break;
+        }
+        ASSERT_EQ(idx.size(), model.size());
+    }
+
+    for (const auto& [id, o] : model) {
+        ASSERT_EQ(idx.find(id), o);
+    }
+    ASSERT_GT(idx.rehashes(), 0);
+}
+
+TYPED_TEST(OrderIndexTest, ReserveKeepsEntries) {
+    TypeParam idx(this->orders, 4);
+    for (uint64_t id = 1; id <= 100; ++id) {
+        idx.insert(id, this->newOrder(id));
+    }
+    const auto before = idx.rehashes();
+    idx.reserve(10000);
+    for (uint64_t id = 101; id <= 10000; ++id) {
+        idx.insert(id, this->newOrder(id));
+    }
+    ASSERT_EQ(idx.rehashes(), before + 1);
+    for (uint64_t id = 1; id <= 10000; ++id) {
+        ASSERT_NE(idx.find(id), nullptr) << id;
+        ASSERT_EQ(idx.find(id)->id, id);
+    }
+}
+
+TEST(IncrementalFibHashIndexTest, GrowthIsSpreadOverLaterWrites) {
+    pool::ObjectPool<Order> orders(4);
+    std::vector<Order*> held;
+    auto add = [&](index::IncrementalFibHashIndex& idx, uint64_t id) {
+        held.push_back(orders.acquire(id, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None));
+        idx.insert(id, held.back());
+    };
+
+    // 16 nodes reserve 32 buckets, which grow past 22 entries.
+    index::IncrementalFibHashIndex idx(orders, 16);
+    uint64_t id = 1;
+    while (idx.rehashes() == 0) {
+        add(idx, id++);
+    }
+    ASSERT_TRUE(idx.migrating());
+
+    // Every entry stays reachable, and erasable, from whichever array holds it.
+    uint64_t writes = 0;
+    for (uint64_t i = 1; i < id; ++i) {
+        ASSERT_NE(idx.find(i), nullptr) << i;
+    }
+    ASSERT_EQ(idx.erase(3), held[2]);
+    ASSERT_EQ(idx.find(3), nullptr);
+    ++writes;
+    while (idx.migrating()) {
+        add(idx, id++);
+        ++writes;
+    }
+    // 32 old buckets at kMigrateStep per write.
+    ASSERT_EQ(writes, 32 / index::IncrementalFibHashIndex::kMigrateStep);
+    ASSERT_EQ(idx.rehashes(), 1);
+    for (uint64_t i = 1; i < id; ++i) {
+        ASSERT_EQ(idx.find(i), i == 3 ? nullptr : held[i - 1]) << i;
+    }
+
+    for (auto* o : held) {
+        orders.release(o);
+    }
+}
+
+// The doubled bucket array is cleared by the writes before growth, so the
+// insert that grows only swaps it in.
+TEST(IncrementalFibHashIndexTest, NextArrayIsReadyBeforeGrowth) {
+    pool::ObjectPool<Order> orders(4);
+    Order* o = orders.acquire(1, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+
+    // 1024 nodes reserve 2048 buckets: preparation starts at 716 entries and
+    // growth at 1434, and 4096 buckets take 64 writes to clear.
+    index::IncrementalFibHashIndex idx(orders, 1024);
+    uint64_t id = 1;
+    for (; id <= 716; ++id) {
+        idx.insert(id, o);
+    }
+    ASSERT_FALSE(idx.prepared());
+    for (; id <= 716 + 4096 / index::IncrementalFibHashIndex::kPrepareStep; ++id) {
+        idx.insert(id, o);
+    }
+    ASSERT_TRUE(idx.prepared());
+    for (; idx.rehashes() == 0; ++id) {
+        ASSERT_TRUE(idx.prepared()) << id;
+        idx.insert(id, o);
+    }
+    ASSERT_EQ(id, 1435);
+    ASSERT_TRUE(idx.migrating());
+    ASSERT_FALSE(idx.prepared());
+    for (uint64_t i = 1; i < id; ++i) {
+        ASSERT_EQ(idx.find(i), o) << i;
+    }
+    orders.release(o);
+}
+
+TEST(DirectIndexTest, SlidingWindowRecyclesPages) {
+    pool::ObjectPool<Order> orders(4);
+    Order* o = orders.acquire(1, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(1, 0), Flag::None);
+
+    // A window of 2000 live ids sliding over 200 pages' worth of ids.
+    constexpr uint64_t kWindow = 2000;
+    constexpr uint64_t kIds = 200 * index::DirectIndex::kPageSize;
+    index::DirectIndex idx(orders, kWindow);
+    for (uint64_t id = 1; id <= kIds; ++id) {
+        idx.insert(id, o);
+        if (id > kWindow) {
+            ASSERT_EQ(idx.erase(id - kWindow), o) << id;
+        }
+    }
+    ASSERT_EQ(idx.size(), kWindow);
+    // The window spans at most 5 pages; retired pages are reused, and the
+    // directory stops reallocating once it fits the window.
+    ASSERT_LE(idx.slabs(), 6);
+    ASSERT_LE(idx.rehashes(), 1);
+    ASSERT_EQ(idx.find(kIds - kWindow), nullptr);
+    ASSERT_EQ(idx.find(kIds - kWindow + 1), o);
+
+    // An id far outside the window lands in the overflow index.
+    idx.insert(uint64_t(1) << 62, o);
+    ASSERT_EQ(idx.find(uint64_t(1) << 62), o);
+    ASSERT_EQ(idx.erase(uint64_t(1) << 62), o);
+    ASSERT_EQ(idx.size(), kWindow);
+
+    orders.release(o);
+}
+
+}  // namespace orderbook::test
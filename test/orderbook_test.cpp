@@ -1,9 +1,16 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <map>
 #include <memory>
+#include <random>
+#include <span>
+#include <sstream>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include "rbtree_levels.hpp"
@@ -153,6 +160,34 @@ TEST_F(LimitOrderTest, TestLimitOrder_CreateWithZeroPrice) {
     n.Verify({"CreateOrder Rejected 170 0 10 ErrInvalidPrice"});
 }
 
+// A limit or amend price between ticks is rejected, release builds included
+// (see the _ndebug test target); it must never reach the tick math.
+TEST_F(LimitOrderTest, TestLimitOrder_CreateOffTickGrid) {
+    TestBook book(n, 16384, 16384, 16384, 0, 1000000);
+
+    n.Reset();
+    book.addOrder(1, Type::Limit, Side::Sell, Decimal(1, 0), Decimal("100.005"), Flag::None);
+    book.addOrder(2, Type::Limit, Side::Sell, Decimal(1, 0), Decimal("100.01"), Flag::None);
+    book.modifyOrder(2, Decimal(1, 0), Decimal("100.015"));
+    const auto h = book.addOrder(3, Type::Limit, Side::Sell, Decimal(1, 0), Decimal("100.02"), Flag::None, orderbook::with_handle);
+    book.modifyOrder(h, Decimal(1, 0), Decimal("100.025"));
+    if constexpr (std::is_same_v<TestLevels<orderbook::PriceType::Bid>, orderbook::ArrayLevels<orderbook::PriceType::Bid>>) {
+        // clang-format off
+        n.Verify({"CreateOrder Rejected 1 0 1 ErrInvalidPrice",
+                  "CreateOrder Accepted 2 1 1",
+                  "ModifyOrder Rejected 2 0 1 ErrInvalidPrice",
+                  "CreateOrder Accepted 3 1 1",
+                  "ModifyOrder Rejected 3 0 1 ErrInvalidPrice"});
+        // clang-format on
+        ASSERT_FALSE(book.hasOrder(1));
+        ASSERT_EQ(book.bestAsk().price, Decimal("100.01"));
+    } else {
+        // The tree has no grid and keeps every price.
+        ASSERT_TRUE(book.hasOrder(1));
+        ASSERT_EQ(book.bestAsk().price, Decimal("100.005"));
+    }
+}
+
 TEST_F(LimitOrderTest, TestLimitOrder_CreateDuplicateOrderID) {
     addDepth(ob);
 
@@ -787,6 +822,797 @@ TEST_F(LimitOrderTest, TestLimitOrder_SellDoesNotCrossPriceLimit) {
     ASSERT_TRUE(ob->hasOrder(2));
 }
 
+// ──────────────────────────────────────────────────────────────────────────────
+// Modify (amend in place)
+// ──────────────────────────────────────────────────────────────────────────────
+
+// Qty down at the same price keeps time priority.
+TEST_F(LimitOrderTest, TestModify_QtyDownKeepsPriority) {
+    processLine(ob, "1	L	S	5	100	N");
+    processLine(ob, "2	L	S	5	100	N");
+    n.Reset();
+
+    ob->modifyOrder(1, Decimal(3, 0), Decimal(100, 0));
+    processLine(ob, "3	M	B	4	0	N");
+    // clang-format off
+    n.Verify({"ModifyOrder Accepted 1 3 3",
+              "CreateOrder Accepted 3 4 4",
+              "1 3 FilledComplete FilledPartial 3 100",
+              "2 3 FilledPartial FilledComplete 1 100"});
+    // clang-format on
+    ASSERT_EQ(ob->toString(), "\t\t\t | 100\t4\n");
+}
+
+// Qty up at the same price moves the order to the back of its queue.
+TEST_F(LimitOrderTest, TestModify_QtyUpLosesPriority) {
+    processLine(ob, "1	L	S	5	100	N");
+    processLine(ob, "2	L	S	5	100	N");
+    n.Reset();
+
+    ob->modifyOrder(1, Decimal(6, 0), Decimal(100, 0));
+    processLine(ob, "3	M	B	4	0	N");
+    // clang-format off
+    n.Verify({"ModifyOrder Accepted 1 6 6",
+              "CreateOrder Accepted 3 4 4",
+              "2 3 FilledPartial FilledComplete 4 100"});
+    // clang-format on
+    ASSERT_EQ(ob->toString(), "\t\t\t | 100\t7\n");
+}
+
+// A price change that does not cross moves the order between levels.
+TEST_F(LimitOrderTest, TestModify_PriceChangeMovesLevel) {
+    addDepth(ob);
+    n.Reset();
+
+    ob->modifyOrder(5, Decimal(4, 0), Decimal(95, 0));
+    n.Verify({"ModifyOrder Accepted 5 4 4"});
+    ASSERT_TRUE(ob->hasOrder(5));
+
+    n.Reset();
+    processLine(ob, "300	L	S	1	80	I");
+    n.Verify({"CreateOrder Accepted 300 1 1", "5 300 FilledPartial FilledComplete 1 95"});
+}
+
+// A price change that crosses matches first, with the amended order as taker.
+TEST_F(LimitOrderTest, TestModify_PriceChangeCrosses) {
+    addDepth(ob);
+    n.Reset();
+
+    ob->modifyOrder(5, Decimal(3, 0), Decimal(100, 0));
+    // clang-format off
+    n.Verify({"ModifyOrder Accepted 5 3 3",
+              "6 5 FilledComplete FilledPartial 2 100"});
+    // clang-format on
+    ASSERT_TRUE(ob->hasOrder(5));
+    ASSERT_FALSE(ob->hasOrder(6));
+    ASSERT_EQ(ob->last_price, Decimal(100, 0));
+
+    n.Reset();
+    ob->modifyOrder(4, Decimal(2, 0), Decimal(110, 0));
+    n.Verify({"ModifyOrder Accepted 4 2 2", "7 4 FilledComplete FilledComplete 2 110"});
+    ASSERT_FALSE(ob->hasOrder(4));
+    ASSERT_FALSE(ob->hasOrder(7));
+
+    n.Reset();
+    ob->cancelOrder(5);
+    n.Verify({"CancelOrder Canceled 5 1 3"});
+}
+
+TEST_F(LimitOrderTest, TestModify_Rejections) {
+    addDepth(ob);
+    n.Reset();
+
+    ob->modifyOrder(999, Decimal(1, 0), Decimal(100, 0));
+    ob->modifyOrder(1, Decimal(0, 0), Decimal(50, 0));
+    ob->modifyOrder(1, Decimal(1, 0), Decimal(0, 0));
+    ob->setMatching(false);
+    ob->modifyOrder(1, Decimal(1, 0), Decimal(100, 0));
+    // clang-format off
+    n.Verify({"ModifyOrder Rejected 999 0 1 ErrOrderNotExists",
+              "ModifyOrder Rejected 1 0 0 ErrInvalidQty",
+              "ModifyOrder Rejected 1 0 1 ErrInvalidPrice",
+              "ModifyOrder Rejected 1 1 1 ErrNoMatching"});
+    // clang-format on
+
+    n.Reset();
+    ob->cancelOrder(1);
+    n.Verify({"CancelOrder Canceled 1 2 2"});
+}
+
+// Handles reach the same order as its id, with the same reports.
+TEST_F(LimitOrderTest, TestHandles_CancelAndModify) {
+    addDepth(ob);
+    n.Reset();
+
+    const auto h = ob->addOrder(20, Type::Limit, Side::Buy, Decimal(3, 0), Decimal(95, 0), Flag::None, orderbook::with_handle);
+    ASSERT_FALSE(h.null());
+    ASSERT_EQ(h.id, 20);
+    ASSERT_TRUE(ob->hasOrder(h));
+
+    ob->modifyOrder(h, Decimal(2, 0), Decimal(95, 0));
+    ob->modifyOrder(h, Decimal(4, 0), Decimal(100, 0));
+    // clang-format off
+    n.Verify({"CreateOrder Accepted 20 3 3",
+              "ModifyOrder Accepted 20 2 2",
+              "ModifyOrder Accepted 20 4 4",
+              "6 20 FilledComplete FilledPartial 2 100"});
+    // clang-format on
+
+    // The id-based API still sees the order, and the handle survives amends.
+    ASSERT_TRUE(ob->hasOrder(20));
+    n.Reset();
+    ob->cancelOrder(h);
+    n.Verify({"CancelOrder Canceled 20 2 4"});
+    ASSERT_FALSE(ob->hasOrder(20));
+    ASSERT_FALSE(ob->hasOrder(h));
+}
+
+// A handle goes stale when its order leaves the book by any path, even once
+// the pool slot is reused.
+TEST_F(LimitOrderTest, TestHandles_StaleHandlesAreRejected) {
+    addDepth(ob);
+
+    // Filled as a maker, then its slot taken by the next order.
+    const auto filled = ob->addOrder(20, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(95, 0), Flag::None, orderbook::with_handle);
+    processLine(ob, "21	M	B	1	0	N");
+    const auto reused = ob->addOrder(22, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(84, 0), Flag::None, orderbook::with_handle);
+    ASSERT_EQ(reused.slot, filled.slot);
+    ASSERT_NE(reused.generation, filled.generation);
+
+    // Cancelled by id.
+    const auto cancelled = ob->addOrder(23, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(85, 0), Flag::None, orderbook::with_handle);
+    ob->cancelOrder(23);
+
+    // Never rested.
+    const auto crossed = ob->addOrder(24, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(100, 0), Flag::None, orderbook::with_handle);
+    ASSERT_TRUE(crossed.null());
+
+    // A live handle with the wrong id.
+    auto forged = reused;
+    forged.id = 6;
+
+    n.Reset();
+    ob->cancelOrder(filled);
+    ob->modifyOrder(cancelled, Decimal(1, 0), Decimal(86, 0));
+    ob->cancelOrder(crossed);
+    ob->cancelOrder(forged);
+    // clang-format off
+    n.Verify({"CancelOrder Rejected 20 0 0 ErrOrderNotExists",
+              "ModifyOrder Rejected 23 0 1 ErrOrderNotExists",
+              "CancelOrder Rejected 24 0 0 ErrOrderNotExists",
+              "CancelOrder Rejected 6 0 0 ErrOrderNotExists"});
+    // clang-format on
+    ASSERT_TRUE(ob->hasOrder(reused));
+    ASSERT_TRUE(ob->hasOrder(6));
+}
+
+// After a spike drains, trim() hands the empty slabs back and the book, and
+// the handles of orders that stayed, carry on as before.
+TEST_F(LimitOrderTest, TestTrim_ReleasesDrainedSlabs) {
+    TestBook book(n, 16384, 16, 16);
+    std::vector<orderbook::OrderHandle> kept;
+    for (uint64_t id = 1; id <= 2000; ++id) {
+        const auto h = book.addOrder(id, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(50 + id % 20, 0), Flag::None, orderbook::with_handle);
+        if (id <= 8) {
+            kept.push_back(h);
+        }
+    }
+    for (uint64_t id = 9; id <= 2000; ++id) {
+        book.cancelOrder(id);
+    }
+    const auto slabs = book.stats().order_pool_slabs;
+    ASSERT_GT(book.trim(), 1024 * sizeof(orderbook::Order));
+    ASSERT_EQ(book.trim(), 0);
+
+    for (uint64_t id = 2001; id <= 3000; ++id) {
+        book.addOrder(id, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(30 + id % 10, 0), Flag::None);
+    }
+    ASSERT_GT(book.stats().order_pool_slabs, slabs);
+    for (const auto& h : kept) {
+        ASSERT_TRUE(book.hasOrder(h));
+    }
+    n.Reset();
+    book.cancelOrder(kept[0]);
+    book.modifyOrder(kept[1], Decimal(2, 0), Decimal(60, 0));
+    book.addOrder(3001, Type::Market, Side::Sell, Decimal(2, 0), Decimal(0, 0), Flag::None);
+    // clang-format off
+    n.Verify({"CancelOrder Canceled 1 1 1",
+              "ModifyOrder Accepted 2 2 2",
+              "CreateOrder Accepted 3001 2 2",
+              "2 3001 FilledComplete FilledComplete 2 60"});
+    // clang-format on
+
+    // The second spike, trimmed in bounded steps, gives back as much.
+    for (uint64_t id = 2001; id <= 3000; ++id) {
+        book.cancelOrder(id);
+    }
+    size_t stepped = 0;
+    do {
+        stepped += book.trim(0, 64);
+    } while (book.trimming());
+    ASSERT_GT(stepped, 512 * sizeof(orderbook::Order));
+    ASSERT_EQ(book.trim(), 0);
+    ASSERT_TRUE(book.hasOrder(kept[2]));
+}
+
+// ──────────────────────────────────────────────────────────────────────────────
+// Compact per-event hooks
+// ──────────────────────────────────────────────────────────────────────────────
+
+// Overrides every compact hook (and no onExecutionReport), formatting reports
+// the same way as the ExecutionReport-based test Notification.
+class CompactNotification : public orderbook::NotificationInterface<CompactNotification> {
+   public:
+    std::vector<std::string> reports;
+
+    void onNew(const orderbook::OrderReport& r) { put(r, OrderStatus::Accepted); }
+    void onCancel(const orderbook::OrderReport& r) { put(r, OrderStatus::Canceled); }
+    void onReplace(const orderbook::OrderReport& r) { put(r, OrderStatus::Accepted); }
+
+    void onReject(const orderbook::RejectReport& r) {
+        std::ostringstream os;
+        os << r.msg_type << " " << OrderStatus::Rejected << " " << r.order_id << " " << r.qty << " " << r.original_qty << " Err" << r.error;
+        reports.push_back(os.str());
+    }
+
+    void onTrade(const orderbook::TradeReport& r) {
+        std::ostringstream os;
+        os << r.maker_order_id << " " << r.taker_order_id << " " << r.maker_status << " " << r.taker_status << " " << r.qty.to_string() << " "
+           << r.price.to_string();
+        reports.push_back(os.str());
+    }
+
+   private:
+    void put(const orderbook::OrderReport& r, OrderStatus status) {
+        std::ostringstream os;
+        os << r.msg_type << " " << status << " " << r.order_id << " " << r.qty << " " << r.original_qty;
+        reports.push_back(os.str());
+    }
+};
+
+TEST_F(LimitOrderTest, TestCompactHooksMatchExecutionReportStream) {
+    CompactNotification cn;
+    orderbook::OrderBook<CompactNotification, TestLevels> compact(cn);
+
+    const auto run = [](auto& book) {
+        book.addOrder(1, Type::Limit, Side::Buy, Decimal(2, 0), Decimal(90, 0), Flag::None);
+        book.addOrder(2, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+        book.addOrder(2, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+        book.addOrder(3, Type::Limit, Side::Sell, Decimal(0, 0), Decimal(100, 0), Flag::None);
+        book.addOrder(4, Type::Market, Side::Buy, Decimal(1, 0), Decimal(0, 0), Flag::None);
+        book.modifyOrder(1, Decimal(3, 0), Decimal(100, 0));
+        book.modifyOrder(9, Decimal(3, 0), Decimal(100, 0));
+        book.cancelOrder(1);
+        book.cancelOrder(1);
+    };
+    run(compact);
+    run(*ob);
+
+    ASSERT_EQ(cn.reports, n.Strings());
+    ASSERT_EQ(cn.reports.size(), 11);
+}
+
+// ──────────────────────────────────────────────────────────────────────────────
+// Top of book
+// ──────────────────────────────────────────────────────────────────────────────
+
+TEST_F(LimitOrderTest, TestBestBidAskAndSpread) {
+    ASSERT_TRUE(ob->bestBid().empty());
+    ASSERT_TRUE(ob->bestAsk().empty());
+    ASSERT_FALSE(ob->spread().has_value());
+
+    addDepth(ob);
+    processLine(ob, "11	L	B	3	90	N");
+
+    auto bid = ob->bestBid();
+    ASSERT_EQ(bid.price, Decimal(90, 0));
+    ASSERT_EQ(bid.qty, Decimal(5, 0));
+    ASSERT_EQ(bid.orders, 2);
+    auto ask = ob->bestAsk();
+    ASSERT_EQ(ask.price, Decimal(100, 0));
+    ASSERT_EQ(ask.qty, Decimal(2, 0));
+    ASSERT_EQ(ask.orders, 1);
+    ASSERT_EQ(ob->spread(), Decimal(10, 0));
+
+    // Sweeping the best bid level moves the best bid down to the next level.
+    processLine(ob, "12	M	S	5	0	N");
+    bid = ob->bestBid();
+    ASSERT_EQ(bid.price, Decimal(80, 0));
+    ASSERT_EQ(bid.orders, 1);
+    ASSERT_EQ(ob->spread(), Decimal(20, 0));
+
+    // Cancelling the best ask moves it up; a better new ask moves it down.
+    ob->cancelOrder(6);
+    ASSERT_EQ(ob->bestAsk().price, Decimal(110, 0));
+    processLine(ob, "13	L	S	1	95	N");
+    ASSERT_EQ(ob->bestAsk().price, Decimal(95, 0));
+    ASSERT_EQ(ob->spread(), Decimal(15, 0));
+
+    // Emptying a side.
+    processLine(ob, "14	M	S	8	0	N");
+    ASSERT_TRUE(ob->bestBid().empty());
+    ASSERT_FALSE(ob->spread().has_value());
+}
+
+TEST_F(LimitOrderTest, TestDepthAtAndLevelInfo) {
+    addDepth(ob);
+    addDepth(ob, 1);
+    processLine(ob, "21	L	S	3	120	N");
+
+    ASSERT_EQ(ob->depthAt(Side::Buy, Decimal(50, 0)), Decimal(4, 0));
+    ASSERT_EQ(ob->depthAt(Side::Sell, Decimal(120, 0)), Decimal(7, 0));
+    auto info = ob->levelInfo(Side::Sell, Decimal(120, 0));
+    ASSERT_EQ(info.price, Decimal(120, 0));
+    ASSERT_EQ(info.qty, Decimal(7, 0));
+    ASSERT_EQ(info.orders, 3);
+
+    // Wrong side, unoccupied, off-grid and out-of-range prices have no level.
+    ASSERT_TRUE(ob->depthAt(Side::Sell, Decimal(50, 0)).is_zero());
+    ASSERT_TRUE(ob->levelInfo(Side::Buy, Decimal(55, 0)).empty());
+    ASSERT_TRUE(ob->levelInfo(Side::Buy, Decimal("50.5")).empty());
+    ASSERT_TRUE(ob->levelInfo(Side::Sell, Decimal(1000000, 0)).empty());
+
+    // Fills and cancels are reflected immediately; an emptied level is gone.
+    processLine(ob, "30	L	B	13	120	N");
+    info = ob->levelInfo(Side::Sell, Decimal(120, 0));
+    ASSERT_EQ(info.qty, Decimal(2, 0));
+    ASSERT_EQ(info.orders, 1);
+    ob->cancelOrder(21);
+    ASSERT_TRUE(ob->levelInfo(Side::Sell, Decimal(120, 0)).empty());
+}
+
+// ──────────────────────────────────────────────────────────────────────────────
+// L2 market data
+// ──────────────────────────────────────────────────────────────────────────────
+
+struct RecordingMarketData {
+    std::vector<std::vector<orderbook::LevelUpdate>> batches;
+
+    void onLevelUpdates(std::span<const orderbook::LevelUpdate> updates) { batches.emplace_back(updates.begin(), updates.end()); }
+
+    // "side price qty orders" for each update of the last batch.
+    std::vector<std::string> last() const {
+        std::vector<std::string> out;
+        for (const auto& u : batches.back()) {
+            std::ostringstream os;
+            os << u.side << " " << u.price.to_string() << " " << u.qty.to_string() << " " << u.orders;
+            out.push_back(os.str());
+        }
+        return out;
+    }
+};
+
+using L2Book = orderbook::OrderBook<Notification, TestLevels, RecordingMarketData>;
+
+static_assert(!orderbook::LevelListener<orderbook::NoMarketData>);
+static_assert(orderbook::LevelListener<RecordingMarketData>);
+
+TEST_F(LimitOrderTest, TestLevelUpdates_OnePerTouchedLevelPerCommand) {
+    Notification l2n;
+    L2Book book(l2n);
+    auto& md = book.marketData();
+
+    book.addOrder(1, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(2, Type::Limit, Side::Sell, Decimal(3, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(3, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(110, 0), Flag::None);
+    ASSERT_EQ(md.batches.size(), 3);
+    ASSERT_EQ(md.last(), std::vector<std::string>{"Sell 110 2 1"});
+
+    // A sweep through two levels that rests the remainder: the emptied level,
+    // the partially filled one and the new bid level, each exactly once.
+    book.addOrder(4, Type::Limit, Side::Buy, Decimal(8, 0), Decimal(110, 0), Flag::None);
+    ASSERT_EQ(md.batches.size(), 4);
+    ASSERT_EQ(md.last(), (std::vector<std::string>{"Sell 100 0 0", "Sell 110 0 0", "Buy 110 1 1"}));
+
+    // Rejects and IoC orders that find nothing publish nothing.
+    book.addOrder(4, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(90, 0), Flag::None);
+    book.addOrder(5, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(120, 0), Flag::IoC);
+    book.cancelOrder(42);
+    book.modifyOrder(42, Decimal(1, 0), Decimal(90, 0));
+    ASSERT_EQ(md.batches.size(), 4);
+
+    // Seqs are book-wide and gap free across batches.
+    uint64_t seq = 0;
+    for (const auto& batch : md.batches) {
+        for (const auto& u : batch) {
+            ASSERT_EQ(u.seq, ++seq);
+        }
+    }
+}
+
+TEST_F(LimitOrderTest, TestLevelUpdates_ModifyAndCancel) {
+    Notification l2n;
+    L2Book book(l2n);
+    auto& md = book.marketData();
+
+    book.addOrder(1, Type::Limit, Side::Buy, Decimal(5, 0), Decimal(90, 0), Flag::None);
+    book.addOrder(2, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(90, 0), Flag::None);
+    book.addOrder(3, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+
+    book.modifyOrder(1, Decimal(3, 0), Decimal(90, 0));
+    ASSERT_EQ(md.last(), std::vector<std::string>{"Buy 90 4 2"});
+
+    book.modifyOrder(1, Decimal(3, 0), Decimal(95, 0));
+    ASSERT_EQ(md.last(), (std::vector<std::string>{"Buy 90 1 1", "Buy 95 3 1"}));
+
+    // Re-pricing through the spread: old level, filled ask, rested remainder.
+    book.modifyOrder(2, Decimal(3, 0), Decimal(100, 0));
+    ASSERT_EQ(md.last(), (std::vector<std::string>{"Buy 90 0 0", "Sell 100 0 0", "Buy 100 1 1"}));
+
+    book.cancelOrder(1);
+    ASSERT_EQ(md.last(), std::vector<std::string>{"Buy 95 0 0"});
+    ASSERT_EQ(md.batches.size(), 7);
+}
+
+// ──────────────────────────────────────────────────────────────────────────────
+// L3 market data
+// ──────────────────────────────────────────────────────────────────────────────
+
+struct RecordingOrderFeed {
+    std::vector<orderbook::OrderEvent> events;
+    size_t batches = 0;
+
+    void onOrderEvents(std::span<const orderbook::OrderEvent> batch) {
+        events.insert(events.end(), batch.begin(), batch.end());
+        ++batches;
+    }
+
+    // "type id side price qty leaves position" for each event since the last call.
+    std::vector<std::string> take() {
+        static constexpr const char* kTypes[] = {"Add", "Reduce", "Delete", "Execute"};
+        std::vector<std::string> out;
+        for (; taken_ < events.size(); ++taken_) {
+            const auto& e = events[taken_];
+            std::ostringstream os;
+            os << kTypes[static_cast<int>(e.type)] << " " << e.order_id << " " << e.side << " " << e.price.to_string() << " " << e.qty.to_string()
+               << " " << e.leaves_qty.to_string() << " " << e.position;
+            out.push_back(os.str());
+        }
+        return out;
+    }
+
+   private:
+    size_t taken_ = 0;
+};
+
+using L3Book = orderbook::OrderBook<Notification, TestLevels, RecordingOrderFeed>;
+
+static_assert(orderbook::OrderListener<RecordingOrderFeed>);
+static_assert(!orderbook::LevelListener<RecordingOrderFeed>);
+
+TEST_F(LimitOrderTest, TestOrderEvents_AddExecuteDelete) {
+    Notification l3n;
+    L3Book book(l3n);
+    auto& md = book.marketData();
+
+    book.addOrder(1, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(2, Type::Limit, Side::Sell, Decimal(3, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(3, Type::Limit, Side::Sell, Decimal(4, 0), Decimal(100, 0), Flag::None);
+    ASSERT_EQ(md.take(), (std::vector<std::string>{"Add 1 Sell 100 2 2 0", "Add 2 Sell 100 3 3 1", "Add 3 Sell 100 4 4 2"}));
+
+    // Full fill of the front maker, partial fill of the next; no Delete for the
+    // filled one, leaves 0 says it is gone.
+    book.addOrder(4, Type::Market, Side::Buy, Decimal(4, 0), Decimal(0, 0), Flag::None);
+    ASSERT_EQ(md.take(), (std::vector<std::string>{"Execute 1 Sell 100 2 0 0", "Execute 2 Sell 100 2 1 0"}));
+
+    book.cancelOrder(3);
+    ASSERT_EQ(md.take(), std::vector<std::string>{"Delete 3 Sell 100 4 0 1"});
+
+    // Rejects publish nothing.
+    book.cancelOrder(3);
+    book.addOrder(2, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    ASSERT_TRUE(md.take().empty());
+    ASSERT_EQ(md.batches, 5);
+
+    uint64_t seq = 0;
+    for (const auto& e : md.events) {
+        ASSERT_EQ(e.seq, ++seq);
+    }
+}
+
+TEST_F(LimitOrderTest, TestOrderEvents_Modify) {
+    Notification l3n;
+    L3Book book(l3n);
+    auto& md = book.marketData();
+
+    book.addOrder(1, Type::Limit, Side::Buy, Decimal(5, 0), Decimal(90, 0), Flag::None);
+    book.addOrder(2, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(90, 0), Flag::None);
+    book.addOrder(3, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+    md.take();
+
+    book.modifyOrder(1, Decimal(3, 0), Decimal(90, 0));
+    ASSERT_EQ(md.take(), std::vector<std::string>{"Reduce 1 Buy 90 2 3 0"});
+
+    // Qty up loses priority: Delete from the front, Add at the back.
+    book.modifyOrder(1, Decimal(4, 0), Decimal(90, 0));
+    ASSERT_EQ(md.take(), (std::vector<std::string>{"Delete 1 Buy 90 3 0 0", "Add 1 Buy 90 4 4 1"}));
+
+    // Re-pricing through the spread: leave the old level, trade, rest the rest.
+    book.modifyOrder(2, Decimal(3, 0), Decimal(100, 0));
+    ASSERT_EQ(md.take(), (std::vector<std::string>{"Delete 2 Buy 90 1 0 0", "Execute 3 Sell 100 2 0 0", "Add 2 Buy 100 1 1 0"}));
+}
+
+// Rebuild every level's FIFO from the events alone and check each reported
+// position against it. Deep levels and cancels from the middle make positions
+// depend on the order of every earlier event, and run the tracker past its
+// first ticket range.
+TEST_F(LimitOrderTest, TestOrderEvents_PositionsMatchQueue) {
+    Notification l3n;
+    L3Book book(l3n);
+    auto& md = book.marketData();
+
+    std::map<std::pair<Side, std::string>, std::vector<uint64_t>> levels;
+    size_t seen = 0;
+    const auto replay = [&] {
+        for (; seen < md.events.size(); ++seen) {
+            const auto& e = md.events[seen];
+            auto& q = levels[{e.side, e.price.to_string()}];
+            switch (e.type) {
+                case orderbook::OrderEventType::Add:
+                    ASSERT_EQ(e.position, q.size());
+                    q.push_back(e.order_id);
+                    break;
+                case orderbook::OrderEventType::Execute:
+                    ASSERT_EQ(e.position, 0);
+                    ASSERT_EQ(q.front(), e.order_id);
+                    if (e.leaves_qty.is_zero()) {
+                        q.erase(q.begin());
+                    }
+                    break;
+                case orderbook::OrderEventType::Reduce:
+                case orderbook::OrderEventType::Delete:
+                    ASSERT_LT(e.position, q.size());
+                    ASSERT_EQ(q[e.position], e.order_id);
+                    if (e.type == orderbook::OrderEventType::Delete) {
+                        q.erase(q.begin() + static_cast<ptrdiff_t>(e.position));
+                    }
+                    break;
+            }
+        }
+    };
+
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> live;
+    for (uint64_t id = 1; id <= 20000; ++id) {
+        const auto pick = rng() % 10;
+        if (pick < 6 || live.empty()) {
+            // Rest on 3 levels a side, occasionally crossing.
+            const Side side = rng() % 2 ? Side::Buy : Side::Sell;
+            const uint64_t price = side == Side::Buy ? 98 + rng() % 3 + (rng() % 50 == 0) * 3 : 101 + rng() % 3 - (rng() % 50 == 0) * 3;
+            book.addOrder(id, Type::Limit, side, Decimal(1 + rng() % 5, 0), Decimal(price, 0), Flag::None);
+            live.push_back(id);
+        } else {
+            const size_t i = rng() % live.size();
+            const uint64_t target = live[i];
+            if (pick < 8) {
+                book.cancelOrder(target);
+                live[i] = live.back();
+                live.pop_back();
+            } else {
+                book.modifyOrder(target, Decimal(1 + rng() % 5, 0), Decimal(98 + rng() % 6, 0));
+            }
+        }
+        replay();
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+}
+
+// Orders loaded from a snapshot never passed through the feed; their positions
+// are still exact.
+TEST_F(LimitOrderTest, TestOrderEvents_PositionsAfterSnapshot) {
+    ob->addOrder(1, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    ob->addOrder(2, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+    ob->addOrder(3, Type::Limit, Side::Sell, Decimal(3, 0), Decimal(100, 0), Flag::None);
+    std::stringstream snap;
+    ASSERT_TRUE(ob->saveSnapshot(snap));
+
+    Notification l3n;
+    L3Book book(l3n);
+    ASSERT_TRUE(book.loadSnapshot(snap));
+    auto& md = book.marketData();
+
+    book.cancelOrder(2);
+    book.addOrder(4, Type::Limit, Side::Sell, Decimal(4, 0), Decimal(100, 0), Flag::None);
+    book.modifyOrder(3, Decimal(1, 0), Decimal(100, 0));
+    ASSERT_EQ(md.take(), (std::vector<std::string>{"Delete 2 Sell 100 2 0 1", "Add 4 Sell 100 4 4 2", "Reduce 3 Sell 100 2 1 1"}));
+}
+
+// A policy may take both feeds; each command delivers L2 then L3.
+struct RecordingBothFeeds {
+    std::vector<char> calls;
+    void onLevelUpdates(std::span<const orderbook::LevelUpdate>) { calls.push_back('2'); }
+    void onOrderEvents(std::span<const orderbook::OrderEvent>) { calls.push_back('3'); }
+};
+
+TEST_F(LimitOrderTest, TestOrderEvents_WithLevelUpdates) {
+    Notification bn;
+    orderbook::OrderBook<Notification, TestLevels, RecordingBothFeeds> book(bn);
+
+    book.addOrder(1, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(2, Type::Market, Side::Buy, Decimal(1, 0), Decimal(0, 0), Flag::None);
+    ASSERT_EQ(book.marketData().calls, (std::vector<char>{'2', '3', '2', '3'}));
+}
+
+// ──────────────────────────────────────────────────────────────────────────────
+// Snapshot / restore
+// ──────────────────────────────────────────────────────────────────────────────
+
+TEST_F(LimitOrderTest, TestSnapshot_RestoresStateWithoutReports) {
+    addDepth(ob);
+    processLine(ob, "11	L	B	3	90	N");
+    processLine(ob, "12	M	S	1	0	N");
+    ob->setMatching(false);
+
+    std::stringstream snap;
+    ASSERT_TRUE(ob->saveSnapshot(snap));
+
+    Notification rn;
+    TestBook restored(rn);
+    ASSERT_TRUE(restored.loadSnapshot(snap));
+    ASSERT_TRUE(rn.Strings().empty());
+    ASSERT_EQ(restored.toString(), ob->toString());
+    ASSERT_EQ(restored.last_price, Decimal(90, 0));
+    ASSERT_TRUE(restored.hasOrder(11));
+    auto bid = restored.bestBid();
+    ASSERT_EQ(bid.qty, Decimal(4, 0));
+    ASSERT_EQ(bid.orders, 2);
+
+    // The matching flag came along: a crossing order is still refused.
+    restored.addOrder(20, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(100, 0), Flag::None);
+    rn.Verify({"CreateOrder Rejected 20 1 1 ErrNoMatching"});
+}
+
+TEST_F(LimitOrderTest, TestSnapshot_Rejections) {
+    addDepth(ob);
+    std::stringstream good;
+    ASSERT_TRUE(ob->saveSnapshot(good));
+    const std::string bytes = good.str();
+
+    // Only into an empty book.
+    {
+        std::stringstream in(bytes);
+        ASSERT_FALSE(ob->loadSnapshot(in));
+    }
+
+    // Different tick grid.
+    {
+        Notification rn;
+        TestBook other(rn, 16384, 16384, 16384, 0, 1000000);
+        std::stringstream in(bytes);
+        ASSERT_FALSE(other.loadSnapshot(in));
+    }
+
+    // Bad magic, bad version, truncated, duplicate id: rejected, book untouched.
+    std::string badMagic = bytes;
+    badMagic[0] ^= 0xff;
+    std::string badVersion = bytes;
+    badVersion[4] ^= 0xff;
+    std::string dup = bytes;
+    // Bids come first, best level first, one order per level: after the 40 byte
+    // header and the level count, each level is a 16 byte level header and a
+    // 26 byte order. Give the second bid (id 4) the id of the first (id 5).
+    const size_t firstId = 40 + 8 + 16;
+    dup.replace(firstId + 26 + 16, 8, dup.substr(firstId, 8));
+    // Header fields and levels: order_count at 32; bid level k's price at
+    // 48 + 42 * k; the ask level count at 258 and the best ask's price at 266.
+    auto withU64 = [&](size_t off, uint64_t v) {
+        std::string data = bytes;
+        std::memcpy(data.data() + off, &v, sizeof(v));
+        return data;
+    };
+    auto withByte = [&](size_t off, char v) {
+        std::string data = bytes;
+        data[off] = v;
+        return data;
+    };
+    uint64_t bestBidFp;
+    std::memcpy(&bestBidFp, bytes.data() + 48, sizeof(bestBidFp));
+    const std::string hugeCount = withU64(32, uint64_t{1} << 62);
+    const std::string badType = withByte(firstId + 24, 7);
+    const std::string badFlag = withByte(firstId + 25, 0x40);
+    const std::string repeatedLevel = withU64(48 + 42, bestBidFp);
+    const std::string crossed = withU64(266, bestBidFp);
+    for (const std::string& data :
+         {badMagic, badVersion, bytes.substr(0, bytes.size() - 1), dup, hugeCount, badType, badFlag, repeatedLevel, crossed}) {
+        Notification rn;
+        TestBook restored(rn);
+        std::stringstream in(data);
+        ASSERT_FALSE(restored.loadSnapshot(in));
+        ASSERT_TRUE(restored.bestBid().empty());
+        ASSERT_TRUE(restored.bestAsk().empty());
+    }
+
+    // A level price between ticks, which the array store has no slot for.
+    if constexpr (std::is_same_v<TestLevels<orderbook::PriceType::Bid>, orderbook::ArrayLevels<orderbook::PriceType::Bid>>) {
+        std::string offGrid = bytes;
+        uint64_t fp;
+        std::memcpy(&fp, offGrid.data() + 40 + 8, sizeof(fp));
+        ++fp;
+        std::memcpy(offGrid.data() + 40 + 8, &fp, sizeof(fp));
+        Notification rn;
+        TestBook restored(rn);
+        std::stringstream in(offGrid);
+        ASSERT_FALSE(restored.loadSnapshot(in));
+        ASSERT_TRUE(restored.bestBid().empty());
+    }
+}
+
+// ──────────────────────────────────────────────────────────────────────────────
+// Stats
+// ──────────────────────────────────────────────────────────────────────────────
+
+using StatsBook = orderbook::OrderBook<Notification, TestLevels, orderbook::NoMarketData, orderbook::CountingStats>;
+
+size_t errorIndex(orderbook::Error e) { return static_cast<size_t>(e); }
+
+TEST_F(LimitOrderTest, TestStats_CountsHotPath) {
+    Notification sn;
+    StatsBook book(sn);
+
+    book.addOrder(1, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(2, Type::Limit, Side::Sell, Decimal(3, 0), Decimal(100, 0), Flag::None);
+    book.addOrder(3, Type::Limit, Side::Sell, Decimal(2, 0), Decimal(110, 0), Flag::None);
+    // Sweeps two levels: two orders at 100, one at 110; the remainder rests.
+    book.addOrder(4, Type::Limit, Side::Buy, Decimal(8, 0), Decimal(110, 0), Flag::None);
+
+    auto s = book.stats();
+    ASSERT_EQ(s.adds, 4);
+    ASSERT_EQ(s.trades, 3);
+    ASSERT_EQ(s.levels_swept[1], 1);
+    ASSERT_EQ(s.orders_per_process[0], 1);
+    ASSERT_EQ(s.orders_per_process[1], 1);
+    ASSERT_EQ(s.live_orders, 1);
+    ASSERT_EQ(s.peak_live_orders, 3);
+
+    book.addOrder(4, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(90, 0), Flag::None);
+    book.cancelOrder(42);
+    book.modifyOrder(42, Decimal(1, 0), Decimal(90, 0));
+    book.addOrder(5, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(120, 0), Flag::None);
+    book.modifyOrder(5, Decimal(2, 0), Decimal(120, 0));
+    book.cancelOrder(4);
+
+    s = book.stats();
+    ASSERT_EQ(s.adds, 5);
+    ASSERT_EQ(s.modifies, 1);
+    ASSERT_EQ(s.cancels, 1);
+    ASSERT_EQ(s.rejects[errorIndex(orderbook::Error::OrderExists)], 1);
+    ASSERT_EQ(s.rejects[errorIndex(orderbook::Error::OrderNotExists)], 2);
+    ASSERT_EQ(s.live_orders, 1);
+    ASSERT_EQ(s.peak_live_orders, 3);
+
+    // An amend that crosses is an aggressive order too.
+    book.addOrder(6, Type::Limit, Side::Buy, Decimal(2, 0), Decimal(115, 0), Flag::None);
+    book.modifyOrder(6, Decimal(2, 0), Decimal(120, 0));
+    s = book.stats();
+    ASSERT_EQ(s.trades, 4);
+    ASSERT_EQ(s.levels_swept[0], 1);
+    ASSERT_EQ(s.orders_per_process[0], 2);
+}
+
+TEST_F(LimitOrderTest, TestStats_StructuralCountersWithoutPolicy) {
+    // Tiny pools, index and tick array, so every cold path runs.
+    Notification sn;
+    TestBook book(sn, 1, 1, 1, 0, 100000000, 64);
+    for (OrderID id = 1; id <= 200; ++id) {
+        book.addOrder(id, Type::Limit, Side::Buy, Decimal(1, 0), Decimal(id, 0), Flag::None);
+    }
+
+    const auto s = book.stats();
+    ASSERT_EQ(s.adds, 0);  // hot-path counters are compiled out
+    ASSERT_EQ(s.live_orders, 0);
+    ASSERT_GT(s.index_rehashes, 0);
+    ASSERT_GT(s.order_pool_slabs, 1);
+    ASSERT_GT(s.index_pool_slabs, 1);
+    ASSERT_GT(s.level_pool_slabs, 2);
+    if constexpr (std::is_same_v<TestLevels<orderbook::PriceType::Bid>, orderbook::ArrayLevels<orderbook::PriceType::Bid>>) {
+        ASSERT_GT(s.level_grows, 0);
+    } else {
+        ASSERT_EQ(s.level_grows, 0);
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -171,4 +171,21 @@ TEST_F(OrderQueueTest, TestOrderQueue_ProcessUsesSnapshotForTradeNotificationAft
     oq->remove(&o2);
 }
 
+TEST_F(OrderQueueTest, TestOrder_PooledOrdersOwnOneCacheLine) {
+    pool::ObjectPool<Order> p(4);
+    std::vector<Order*> orders;
+    for (OrderID id = 1; id <= 9; ++id) {  // spans more than one slab
+        orders.push_back(p.acquire(id, Type::Limit, Side::Sell, Decimal(1, 0), Decimal(100, 0), Flag::None));
+    }
+    for (auto* o : orders) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(o) % 64, 0) << o->id;
+
+        // Matching reads only the list hook, id and qty: the first half line.
+        const auto* base = reinterpret_cast<const char*>(o);
+        EXPECT_LE(reinterpret_cast<const char*>(&o->id) + sizeof(o->id) - base, 32);
+        EXPECT_LE(reinterpret_cast<const char*>(&o->qty) + sizeof(o->qty) - base, 32);
+        p.release(o);
+    }
+}
+
 }  // namespace orderbook::test
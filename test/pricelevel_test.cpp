@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <random>
 
 #include "rbtree_levels.hpp"
 #include "util.cpp"
@@ -104,5 +105,80 @@ TEST_F(PriceLevelTest, TestPriceLevel_RbTree) { runTestPriceLevel<RbTreeLevels>(
 TEST_F(PriceLevelTest, TestPriceFinding_Array) { runTestPriceFinding<ArrayLevels>(); }
 TEST_F(PriceLevelTest, TestPriceFinding_RbTree) { runTestPriceFinding<RbTreeLevels>(); }
 
+TEST_F(PriceLevelTest, TestTickDivider_MatchesDivision) {
+    std::mt19937_64 rng(16);
+    for (const uint64_t tick : {uint64_t{1}, uint64_t{3}, uint64_t{8}, uint64_t{5000000}, uint64_t{100000000}, uint64_t{12345677}, uint64_t{1} << 63}) {
+        const detail::TickDivider div(tick);
+        for (int i = 0; i < 10000; ++i) {
+            const uint64_t q = rng() % (UINT64_MAX / tick);
+            const uint64_t n = q * tick;
+            uint64_t got = 0;
+            ASSERT_TRUE(div.divides(n, got)) << tick << " " << n;
+            ASSERT_EQ(got, q);
+            ASSERT_EQ(div.exact(n), q);
+            ASSERT_EQ(div.floor(n), q);
+            ASSERT_EQ(div.ceil(n), q);
+
+            const uint64_t m = rng();
+            ASSERT_EQ(div.divides(m, got), m % tick == 0) << tick << " " << m;
+            ASSERT_EQ(div.floor(m), m / tick);
+            if (m <= UINT64_MAX - tick) {
+                ASSERT_EQ(div.ceil(m), (m + tick - 1) / tick);
+            }
+        }
+    }
+}
+
+TEST_F(PriceLevelTest, TestPriceFinding_ArrayOddTick) {
+    // 0.05 tick (5000000 fp = 78125 * 2^6) from 100.00: on-grid lookups take the
+    // multiply path, the off-grid queries fall back to division.
+    PriceLevel<PriceType::Ask, ArrayLevels<PriceType::Ask>> askLevel(LevelStoreConfig{10, 10000000000, 5000000, 256});
+
+    std::unique_ptr<Order> o1(new Order(1, Type::Limit, Side::Sell, Decimal(5, 0), Decimal("100.05"), Flag::None));
+    std::unique_ptr<Order> o2(new Order(2, Type::Limit, Side::Sell, Decimal(5, 0), Decimal("100.20"), Flag::None));
+    askLevel.append(o1.get());
+    askLevel.append(o2.get());
+
+    ASSERT_EQ(askLevel.getQueue()->price(), Decimal("100.05"));
+    ASSERT_EQ(askLevel.largestLessThan(Decimal("100.20"))->price(), Decimal("100.05"));
+    ASSERT_EQ(askLevel.largestLessThan(Decimal("100.07"))->price(), Decimal("100.05"));
+    ASSERT_EQ(askLevel.largestLessThan(Decimal("100.05")), nullptr);
+    ASSERT_EQ(askLevel.smallestGreaterThan(Decimal("100.05"))->price(), Decimal("100.20"));
+    ASSERT_EQ(askLevel.smallestGreaterThan(Decimal("100.07"))->price(), Decimal("100.20"));
+    ASSERT_EQ(askLevel.smallestGreaterThan(Decimal("100.20")), nullptr);
+
+    askLevel.remove(o1.get());
+    askLevel.remove(o2.get());
+}
+
+TEST_F(PriceLevelTest, TestPriceFinding_ArrayOnGrid) {
+    // 0.01 tick from 100.00: off-grid and below-base prices have no slot.
+    ArrayLevels<PriceType::Ask> store(LevelStoreConfig{10, 10000000000, 1000000, 256});
+    ASSERT_TRUE(store.onGrid(Decimal("100.00")));
+    ASSERT_TRUE(store.onGrid(Decimal("100.01")));
+    ASSERT_TRUE(store.onGrid(Decimal("1000.00")));
+    ASSERT_FALSE(store.onGrid(Decimal("100.005")));
+    ASSERT_FALSE(store.onGrid(Decimal("99.99")));
+    ASSERT_EQ(store.find(Decimal("100.005")), nullptr);
+    ASSERT_TRUE(RbTreeLevels<PriceType::Ask>(LevelStoreConfig{}).onGrid(Decimal("100.005")));
+}
+
+TEST_F(PriceLevelTest, TestPriceFinding_ArrayTickUnits) {
+    // Tick-unit grid: the raw fixed-point value is the tick count.
+    PriceLevel<PriceType::Bid, ArrayLevels<PriceType::Bid>> bidLevel(LevelStoreConfig{10, 0, 1, 256});
+
+    std::unique_ptr<Order> o1(new Order(1, Type::Limit, Side::Buy, decimalFromFp(3), decimalFromFp(120), Flag::None));
+    std::unique_ptr<Order> o2(new Order(2, Type::Limit, Side::Buy, decimalFromFp(4), decimalFromFp(7), Flag::None));
+    bidLevel.append(o1.get());
+    bidLevel.append(o2.get());
+
+    ASSERT_EQ(bidLevel.getQueue()->price().fp, 120);
+    ASSERT_EQ(bidLevel.largestLessThan(decimalFromFp(120))->price().fp, 7);
+    ASSERT_EQ(bidLevel.volume().fp, 7);
+
+    bidLevel.remove(o1.get());
+    bidLevel.remove(o2.get());
+}
+
 }  // namespace test
 }  // namespace orderbook
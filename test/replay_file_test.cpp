@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../bench/replay_file.hpp"
+#include "util.cpp"
+
+using orderbook::Command;
+using orderbook::CommandType;
+using orderbook::bench::ReplayHeader;
+using orderbook::bench::ReplayReader;
+using orderbook::bench::ReplayRecord;
+using orderbook::bench::ReplayWriter;
+
+using TestBook = orderbook::OrderBook<Notification>;
+
+class ReplayFileTest : public ::testing::Test {
+   protected:
+    std::string path;
+
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        path = (std::filesystem::temp_directory_path() / ("ob_replay_" + std::to_string(::getpid()) + "_" + info->name() + ".bin")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+};
+
+TEST_F(ReplayFileTest, RoundTripReproducesLiveBook) {
+    // More than one writer buffer, so the file is written in several chunks.
+    const auto cmds = randomCommands(ReplayWriter::kBuffer * 2 + 17, 2024);
+
+    Notification liveN;
+    TestBook live(liveN);
+    {
+        ReplayWriter writer(path);
+        ASSERT_TRUE(writer.ok());
+        for (size_t i = 0; i < cmds.size(); ++i) {
+            writer.append(orderbook::bench::toReplayRecord(1000 * i, i + 1, cmds[i]));
+            live.apply(cmds[i]);
+        }
+    }
+
+    ReplayReader reader(path);
+    ASSERT_TRUE(reader.ok());
+    const auto records = reader.records();
+    ASSERT_EQ(records.size(), cmds.size());
+    ASSERT_EQ(records[5].ts_ns, 5000);
+    ASSERT_EQ(records[5].seq, 6);
+
+    Notification replayN;
+    TestBook replayed(replayN);
+    for (const ReplayRecord& r : records) {
+        replayed.apply(orderbook::bench::toCommand(r));
+    }
+    ASSERT_EQ(replayN.Strings(), liveN.Strings());
+    ASSERT_EQ(replayed.toString(), live.toString());
+}
+
+TEST_F(ReplayFileTest, TimestampsFollowTheCaptureClock) {
+    {
+        ReplayWriter writer(path);
+        for (const auto& c : randomCommands(3, 1)) {
+            writer.append(0, c);
+        }
+    }
+    ReplayReader reader(path);
+    const auto records = reader.records();
+    ASSERT_EQ(records.size(), 3);
+    ASSERT_GT(records[0].ts_ns, 0);
+    ASSERT_LE(records[0].ts_ns, records[1].ts_ns);
+    ASSERT_LE(records[1].ts_ns, records[2].ts_ns);
+}
+
+TEST_F(ReplayFileTest, PartialTrailingRecordIsIgnored) {
+    {
+        ReplayWriter writer(path);
+        for (const auto& c : randomCommands(4, 7)) {
+            writer.append(0, c);
+        }
+    }
+    // A recorder that died mid-write leaves part of a record behind.
+    std::filesystem::resize_file(path, sizeof(ReplayHeader) + 3 * sizeof(ReplayRecord) + 20);
+
+    ReplayReader reader(path);
+    ASSERT_TRUE(reader.ok());
+    ASSERT_EQ(reader.records().size(), 3);
+}
+
+TEST_F(ReplayFileTest, RejectsForeignFiles) {
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << std::string(sizeof(ReplayHeader) + sizeof(ReplayRecord), 'x');
+    }
+    ASSERT_FALSE(ReplayReader(path).ok());
+    ASSERT_FALSE(ReplayReader("/nonexistent-dir/replay.bin").ok());
+    ASSERT_FALSE(ReplayWriter("/nonexistent-dir/replay.bin").ok());
+}
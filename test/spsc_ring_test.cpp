@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.hpp"
+
+using orderbook::SpscRing;
+
+TEST(SpscRingTest, CapacityRoundsUpToPowerOfTwo) {
+    ASSERT_EQ(SpscRing<int>(5).capacity(), 8);
+    ASSERT_EQ(SpscRing<int>(8).capacity(), 8);
+    ASSERT_EQ(SpscRing<int>(0).capacity(), 2);
+}
+
+TEST(SpscRingTest, FullAndEmpty) {
+    SpscRing<int> ring(4);
+    int v = 0;
+    ASSERT_TRUE(ring.empty());
+    ASSERT_FALSE(ring.tryPop(v));
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.tryPush(i));
+    }
+    ASSERT_FALSE(ring.tryPush(4));
+
+    ASSERT_TRUE(ring.tryPop(v));
+    ASSERT_EQ(v, 0);
+    ASSERT_TRUE(ring.tryPush(4));
+
+    std::vector<int> got;
+    ASSERT_EQ(ring.consume(3, [&](int x) { got.push_back(x); }), 3);
+    ASSERT_EQ(got, (std::vector<int>{1, 2, 3}));
+    ASSERT_EQ(ring.consume(10, [&](int x) { got.push_back(x); }), 1);
+    ASSERT_EQ(got.back(), 4);
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, TwoThreadsPreserveOrder) {
+    constexpr uint64_t kCount = 1'000'000;
+    SpscRing<uint64_t> ring(1024);
+
+    std::thread producer([&ring] {
+        for (uint64_t i = 0; i < kCount; ++i) {
+            while (!ring.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint64_t expected = 0;
+    bool inOrder = true;
+    const auto check = [&](uint64_t x) {
+        inOrder = inOrder && x == expected;
+        ++expected;
+    };
+    while (expected < kCount) {
+        if (ring.consume(64, check) == 0) {
+            uint64_t x;
+            if (ring.tryPop(x)) {
+                check(x);
+            }
+        }
+    }
+    producer.join();
+
+    ASSERT_TRUE(inOrder);
+    ASSERT_TRUE(ring.empty());
+}
@@ -3,6 +3,7 @@
 #include <boost/algorithm/string.hpp>
 #include <cstdlib>
 #include <iostream>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -68,3 +69,60 @@ class Notification : public orderbook::NotificationInterface<Notification> {
     }
 };
 
+// Shape of a randomCommands stream. Of every 10 commands, adds are the first
+// `adds` (one of them a market order), then cancels up to 8, then modifies.
+// Ids come from [1, max_id], small enough that duplicates, unknown ids and
+// re-used ids all occur.
+struct CommandMix {
+    enum class Flags {
+        None,  // every add plain
+        IoC,   // one add in ten immediate-or-cancel
+        All,   // IoC, AoN and FoK each on one add in eight
+    };
+    OrderID max_id = 200;
+    int adds = 5;
+    Flags flags = Flags::IoC;
+};
+
+// Seeded command stream over prices 90..110 and quantities 1..10; the same
+// seed and mix always give the same commands.
+std::vector<orderbook::Command> randomCommands(size_t count, uint32_t seed, const CommandMix& mix = {}) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<OrderID> id(1, mix.max_id);
+    std::uniform_int_distribution<int> qty(1, 10);
+    std::uniform_int_distribution<int> price(90, 110);
+    std::uniform_int_distribution<int> flag(0, 7);
+    const Flag flags[] = {Flag::None, Flag::None, Flag::None, Flag::None, Flag::None, Flag::IoC, Flag::AoN, Flag::FoK};
+
+    std::vector<orderbook::Command> cmds;
+    cmds.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        orderbook::Command c;
+        const int k = kind(rng);
+        c.id = id(rng);
+        c.qty = Decimal(qty(rng), 0);
+        c.price = Decimal(price(rng), 0);
+        c.side = (rng() & 1) ? Side::Buy : Side::Sell;
+        if (k < mix.adds) {
+            c.kind = orderbook::CommandType::Add;
+            c.type = k == 0 ? Type::Market : Type::Limit;
+            switch (mix.flags) {
+                case CommandMix::Flags::None:
+                    break;
+                case CommandMix::Flags::IoC:
+                    c.flag = k == 1 ? Flag::IoC : Flag::None;
+                    break;
+                case CommandMix::Flags::All:
+                    c.flag = flags[flag(rng)];
+                    break;
+            }
+        } else if (k < 8) {
+            c.kind = orderbook::CommandType::Cancel;
+        } else {
+            c.kind = orderbook::CommandType::Modify;
+        }
+        cmds.push_back(c);
+    }
+    return cmds;
+}